@@ -0,0 +1,82 @@
+#ifndef ASSETBUNDLE_HPP
+#define ASSETBUNDLE_HPP
+
+#include "Tile.hpp"
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+// Straight RGBA pixels of a decoded image, row by row
+struct AssetImage
+{
+    int width;
+    int height;
+    std::vector <std::uint8_t> pixels;
+};
+
+struct AtlasRect
+{
+    int left;
+    int top;
+    int width;
+    int height;
+};
+
+/*
+ * Everything the game loads at start packed into one block of bytes:
+ * the texture atlas with every kind of tile already drawn, the rectangles of the tiles and the font
+ *
+ * The block starts with a 32-byte little-endian header: the "CLAB" signature, the format version,
+ * the size of a sprite, the width and the height of the atlas, the number of tiles and the size of the font
+ * Then the rectangles follow, four 16-bit numbers each, then the RGBA pixels of the atlas and the font file
+ *
+ * The packer decodes the images and draws the atlas once at build time,
+ * the game only checks the header and points into the block compiled into it
+ */
+class AssetBundle
+{
+    public:
+        // Points into the given bytes, which must outlive the bundle
+        // Throws std::runtime_error if they are not a bundle
+        AssetBundle(const unsigned char*, const std::size_t);
+        virtual ~AssetBundle();
+
+        // Draws the cell and the balls of every color into the atlas,
+        // the balls of the next move are half as big and the selected ones are one and a half times bigger
+        static std::vector <unsigned char> pack(const AssetImage&, const std::vector <AssetImage>&,
+                                                const std::vector <unsigned char>&, const int);
+
+        int getSpriteSize() const;
+        int getAtlasWidth() const;
+        int getAtlasHeight() const;
+
+        // The colors are multiplied by the alpha, as drawing the sprites into a texture leaves them
+        const unsigned char* getAtlasPixels() const;
+
+        // Tiles without a sprite have empty rectangles
+        AtlasRect getTextureRect(const Tile) const;
+
+        const unsigned char* getFontData() const;
+        std::size_t getFontSize() const;
+
+    private:
+        static constexpr int m_headerSize = 32;
+        static constexpr int m_rectSize = 8;
+        static constexpr std::uint32_t m_version = 1;
+
+        const unsigned char* m_data;
+        int m_spriteSize;
+        int m_atlasWidth;
+        int m_atlasHeight;
+        std::size_t m_fontSize;
+
+        static void drawSprite(std::vector <unsigned char>&, const int, const AtlasRect&, const AssetImage&, const float);
+        static void sampleImage(const AssetImage&, const float, const float, float (&)[4]);
+
+        static void putInteger(unsigned char*, const std::uint64_t, const int);
+        static std::uint64_t getInteger(const unsigned char*, const int);
+};
+
+#endif // ASSETBUNDLE_HPP
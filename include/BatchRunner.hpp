@@ -0,0 +1,96 @@
+#ifndef BATCHRUNNER_HPP
+#define BATCHRUNNER_HPP
+
+#include "GameEngine.hpp"
+#include "MovePolicy.hpp"
+#include "Simulator.hpp"
+#include "SimulationStatistics.hpp"
+#include "ResultFile.hpp"
+#include "ReplayRecorder.hpp"
+#include "Logger.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <functional>
+#include <string>
+#include <cstdint>
+
+struct BatchSettings
+{
+    int gameCount;
+    int widthInTiles;
+    int heightInTiles;
+    int colorCount;
+    int maxMoveCount;
+    std::uint64_t masterSeed;
+    RandomNumberGenerator::Algorithm randomAlgorithm;
+    int threadCount;
+    int gamesPerChunk;
+
+    // The policy with its parameters, written into the result file to check a resumed batch
+    std::string policyName;
+
+    // Every game continues this snapshot instead of starting on an empty tilemap if it is not empty,
+    // the games differ by the balls that fall after it
+    std::vector <unsigned char> startPosition;
+
+    // The chunks of games already in the result file are counted without playing them again,
+    // so a batch stopped in the middle goes on from where it was
+    bool isResumed = false;
+};
+
+/*
+ * Plays independent games on all threads
+ *
+ * Every thread owns its engine and its policy
+ * Game 'i' is seeded from the master seed and 'i' only,
+ * so its result is the same for any number of threads
+ *
+ * Games are split into chunks, and every thread starts with an equal share of them
+ * A thread takes chunks from the front of its share,
+ * and when it runs out, it steals the back half of another thread's share
+ */
+class BatchRunner
+{
+    public:
+        using PolicyFactory = std::function <std::unique_ptr <MovePolicy>()>;
+
+        BatchRunner(const BatchSettings&, const PolicyFactory&);
+        virtual ~BatchRunner();
+
+        // Results are also written into the first file and replays of the games are appended to the second one
+        // if their paths are not empty
+        SimulationStatistics run(const std::string&, const std::string&);
+
+        // The engines of all threads log into it, it must outlive the runs
+        void setLogger(Logger*);
+
+    private:
+        // The share of a thread is a range of chunks [begin, end) packed into one word,
+        // so both the owner and the thieves change it with a single compare-and-swap
+        struct alignas(64) ChunkRange
+        {
+            std::atomic <std::uint64_t> range;
+        };
+
+        BatchSettings m_settings;
+        PolicyFactory m_makePolicy;
+        std::vector <ChunkRange> m_ranges;
+        Logger* m_logger;
+
+        // The results read from the file of a resumed batch
+        std::vector <GameRecord> m_writtenRecords;
+
+        static std::uint64_t packRange(const std::uint32_t, const std::uint32_t);
+
+        bool takeChunk(const int, int&);
+        bool stealChunks(const int);
+        bool isChunkWritten(const int, const int) const;
+        ResultHeader makeResultHeader() const;
+        void work(const int, SimulationStatistics&, const std::string&, const std::string&);
+};
+
+#endif // BATCHRUNNER_HPP
@@ -0,0 +1,118 @@
+#ifndef BITBOARD_HPP
+#define BITBOARD_HPP
+
+#include <vector>
+#include <cstdint>
+#include <bit>
+#include <algorithm>
+
+/*
+ * One bit per cell of the padded tilemap, bit 'i' stands for the cell with index 'i'
+ *
+ * The default 9x9 board with its frame fits in two words,
+ * larger boards use as many words as they need
+ *
+ * Shifting by a step of the tilemap moves every bit to the neighbour cell,
+ * and since the frame bits are never set, a run of bits never wraps around a row
+ */
+class BitBoard
+{
+    public:
+        BitBoard();
+        virtual ~BitBoard();
+
+        void resize(const int);
+        void clear();
+
+        bool test(const int) const;
+        void set(const int);
+        void reset(const int);
+
+        bool any() const;
+        int count() const;
+        bool intersects(const BitBoard&) const;
+
+        // Finds the lowest set bit starting from the given one, returns -1 if there is none
+        int findNext(const int) const;
+
+        void assign(const BitBoard&);
+        void assignShiftedUp(const BitBoard&, const int);
+        void assignShiftedDown(const BitBoard&, const int);
+
+        void andWith(const BitBoard&);
+        void orWith(const BitBoard&);
+        void andNotWith(const BitBoard&);
+        void andWithShiftedUp(const BitBoard&, const int);
+        void andWithShiftedDown(const BitBoard&, const int);
+        void orWithShiftedUp(const BitBoard&, const int);
+        void orWithShiftedDown(const BitBoard&, const int);
+
+    private:
+        static constexpr int m_bitsPerWord = 64;
+
+        std::vector <std::uint64_t> m_words;
+
+        std::uint64_t getWordShiftedUp(const int, const int) const;
+        std::uint64_t getWordShiftedDown(const int, const int) const;
+};
+
+/*
+ * Single bit access is used on every change of the tilemap,
+ * so it is kept here to be inlined
+ */
+
+inline bool BitBoard::test(const int bit) const
+{
+    return (m_words[bit / m_bitsPerWord] >> (bit % m_bitsPerWord)) & 1;
+}
+
+inline void BitBoard::set(const int bit)
+{
+    m_words[bit / m_bitsPerWord] |= std::uint64_t(1) << (bit % m_bitsPerWord);
+}
+
+inline void BitBoard::reset(const int bit)
+{
+    m_words[bit / m_bitsPerWord] &= ~(std::uint64_t(1) << (bit % m_bitsPerWord));
+}
+
+/*
+ * Word 'i' of the bitboard shifted toward higher bits by 'n'
+ */
+inline std::uint64_t BitBoard::getWordShiftedUp(const int i, const int n) const
+{
+    const auto wordShift = n / m_bitsPerWord;
+    const auto bitShift = n % m_bitsPerWord;
+
+    const auto source = i - wordShift;
+    if (source < 0)
+        return 0;
+
+    auto word = m_words[source] << bitShift;
+    if (bitShift != 0 && source > 0)
+        word |= m_words[source - 1] >> (m_bitsPerWord - bitShift);
+
+    return word;
+}
+
+/*
+ * Word 'i' of the bitboard shifted toward lower bits by 'n'
+ */
+inline std::uint64_t BitBoard::getWordShiftedDown(const int i, const int n) const
+{
+    const auto wordShift = n / m_bitsPerWord;
+    const auto bitShift = n % m_bitsPerWord;
+    const auto size = static_cast <int>(m_words.size());
+
+    const auto source = i + wordShift;
+    if (source >= size)
+        return 0;
+
+    auto word = m_words[source] >> bitShift;
+    if (bitShift != 0 && source + 1 < size)
+        word |= m_words[source + 1] << (m_bitsPerWord - bitShift);
+
+    return word;
+}
+
+#endif // BITBOARD_HPP
@@ -0,0 +1,127 @@
+#ifndef BOARD_HPP
+#define BOARD_HPP
+
+#include "Tile.hpp"
+
+#include <vector>
+#include <span>
+#include <algorithm>
+
+/*
+ * The tilemap is kept in one row-major buffer of one-byte tiles
+ * surrounded by a frame of Tile::Border cells
+ *
+ * Every cell is addressed by a single index, a step to a neighbour is an index offset,
+ * and any walk from a real cell stops at the frame without bounds checks
+ */
+class Board
+{
+    public:
+        Board();
+        virtual ~Board();
+
+        void resize(const int, const int);
+        void clear();
+
+        int getWidth() const;
+        int getHeight() const;
+
+        // The distance between vertically adjacent cells, the width plus the frame
+        int getStride() const;
+
+        // The size of the whole buffer including the frame
+        int getCellCount() const;
+
+        int toIndex(const int, const int) const;
+        int toRow(const int) const;
+        int toColumn(const int) const;
+
+        // The whole buffer including the frame, row by row
+        std::span <const Tile> getCells() const;
+        std::span <Tile> getCells();
+
+        Tile get(const int, const int) const;
+        std::span <const Tile> getRow(const int) const;
+
+        Tile operator[](const int) const;
+        Tile& operator[](const int);
+
+    private:
+        std::vector <Tile> m_tiles;
+
+        int m_width;
+        int m_height;
+        int m_stride;
+};
+
+/*
+ * The accessors are used in every scan over the tilemap,
+ * so they are kept here to be inlined
+ */
+
+inline int Board::getWidth() const
+{
+    return m_width;
+}
+
+inline int Board::getHeight() const
+{
+    return m_height;
+}
+
+inline int Board::getStride() const
+{
+    return m_stride;
+}
+
+inline int Board::getCellCount() const
+{
+    return static_cast <int>(m_tiles.size());
+}
+
+inline int Board::toIndex(const int row, const int column) const
+{
+    return (row + 1) * m_stride + column + 1;
+}
+
+inline int Board::toRow(const int index) const
+{
+    return index / m_stride - 1;
+}
+
+inline int Board::toColumn(const int index) const
+{
+    return index % m_stride - 1;
+}
+
+inline std::span <const Tile> Board::getCells() const
+{
+    return std::span <const Tile>(m_tiles);
+}
+
+inline std::span <Tile> Board::getCells()
+{
+    return std::span <Tile>(m_tiles);
+}
+
+inline Tile Board::get(const int row, const int column) const
+{
+    return m_tiles[toIndex(row, column)];
+}
+
+inline std::span <const Tile> Board::getRow(const int row) const
+{
+    return std::span <const Tile>(m_tiles.data() + toIndex(row, 0), m_width);
+}
+
+inline Tile Board::operator[](const int index) const
+{
+    return m_tiles[index];
+}
+
+inline Tile& Board::operator[](const int index)
+{
+    return m_tiles[index];
+}
+
+#endif // BOARD_HPP
@@ -0,0 +1,50 @@
+#ifndef COLORBITBOARDS_HPP
+#define COLORBITBOARDS_HPP
+
+#include "Tile.hpp"
+#include "Board.hpp"
+#include "BitBoard.hpp"
+
+#include <vector>
+
+/*
+ * Keeps one occupancy bitboard per ball color
+ *
+ * Lines are found with shifts and ANDs over whole bitboards:
+ * a bit survives 'n - 1' ANDs with the bitboard shifted by one step each time
+ * only if 'n' balls of the same color start at its cell along that step
+ *
+ * The engine uses it instead of the tile by tile scans
+ * when it is built with COLORLINES_BITBOARD_STREAKS defined
+ */
+class ColorBitBoards
+{
+    public:
+        ColorBitBoards();
+        virtual ~ColorBitBoards();
+
+        void resize(const Board&, const int, const int);
+        void update(const int, const Tile, const Tile);
+
+        // Marks the ball and all the lines going through it, the ball must be a usual one
+        const BitBoard& findStreaksThrough(const int, const Tile);
+
+        // Marks all the lines of the given color on the board
+        const BitBoard& findLines(const Tile);
+
+        // Counts the balls of all colors that are a part of some line
+        int countLineBalls();
+
+    private:
+        std::vector <BitBoard> m_balls;
+        int m_steps[4];
+        int m_minStreakLength;
+
+        BitBoard m_runs;
+        BitBoard m_lines;
+        BitBoard m_streaks;
+
+        void findLinesAlong(const BitBoard&, const int);
+};
+
+#endif // COLORBITBOARDS_HPP
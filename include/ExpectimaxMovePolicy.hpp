@@ -0,0 +1,89 @@
+#ifndef EXPECTIMAXMOVEPOLICY_HPP
+#define EXPECTIMAXMOVEPOLICY_HPP
+
+#include "MovePolicy.hpp"
+#include "TranspositionTable.hpp"
+
+#include <optional>
+#include <chrono>
+
+struct SearchResult
+{
+    Move bestMove;
+
+    // The best move and the best answers to it, the balls of every chance node are those of its first sample
+    std::vector <Move> principalVariation;
+
+    // The expected score gained by the end of the searched moves, together with the value of the last position
+    float value;
+    int depth;
+    std::int64_t nodeCount;
+};
+
+/*
+ * Looks ahead with expectimax search:
+ * 1. at our moves the best move is taken;
+ * 2. after a move the expected balls become real ones as the rules say,
+ *    and the new expected balls are random, so such a move is averaged over several samples of them
+ *
+ * The search makes and takes back moves on one engine of the policy, the position of the game is copied into it
+ * once for every search, without the moves of the game to take back
+ * Its generator is seeded from the position and the number of the sample,
+ * so the samples do not depend on the balls the real game is going to give
+ *
+ * The search deepens one move at a time until the time is out or the maximal depth is reached,
+ * and only the best moves found by the previous iteration are searched deeper
+ */
+class ExpectimaxMovePolicy : public MovePolicy
+{
+    public:
+        ExpectimaxMovePolicy();
+        virtual ~ExpectimaxMovePolicy();
+
+        bool chooseMove(const GameEngine&, Move&) override;
+        void setSeed(const std::uint64_t) override;
+
+        // Zero time means no limit, the search then stops at the maximal depth only
+        void setTimeBudget(const std::chrono::milliseconds);
+        void setMaxDepth(const int);
+        void setSampleCount(const int);
+
+        // How many moves are searched deeper at the root and below it
+        void setRootWidth(const int);
+        void setBeamWidth(const int);
+
+        // Returns false if there is no possible move
+        bool search(const GameEngine&, SearchResult&);
+
+    private:
+        std::optional <GameEngine> m_game;
+        TranspositionTable m_table;
+        std::uint64_t m_seed;
+
+        std::chrono::milliseconds m_timeBudget;
+        std::chrono::steady_clock::time_point m_deadline;
+        int m_maxDepth;
+        int m_sampleCount;
+        int m_rootWidth;
+        int m_beamWidth;
+
+        std::int64_t m_nodeCount;
+        bool m_isAborted;
+
+        // Buffers for every ply, so the search does not allocate after the first moves
+        std::vector <std::vector <Move>> m_moves;
+        std::vector <std::vector <std::pair <int, int>>> m_ratings;
+        std::vector <std::vector <Move>> m_lines;
+        std::vector <std::vector <Move>> m_sampleLines;
+
+        void prepareBuffers(const int);
+        bool isTimeOut();
+
+        float searchMove(const Move&, const int, const int);
+        float searchPosition(const int, const int);
+        void selectMoves(const int, const int);
+
+        float evaluate() const;
+};
+
+#endif // EXPECTIMAXMOVEPOLICY_HPP
@@ -0,0 +1,101 @@
+#ifndef FRAMEPROFILER_HPP
+#define FRAMEPROFILER_HPP
+
+#include <array>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+// Parts of a frame of the main loop in the order they run
+enum class FramePhase : int
+{
+    Timer,
+    Events,
+    InfoPanel,
+    TileMap,
+    Hint,
+    GameOverPanel,
+    Overlay,
+    Display,
+    Count
+};
+
+struct FrameSample
+{
+    std::uint64_t index;
+    std::array <std::uint32_t, static_cast <int>(FramePhase::Count)> phaseMicroseconds;
+    std::uint32_t drawCallCount;
+
+    std::uint32_t getTotalMicroseconds() const;
+};
+
+// Percentiles of the latest frames in milliseconds
+struct FrameStatistics
+{
+    int frameCount;
+    int renderedFrameCount;
+    double frameMedian;
+    double frame99th;
+    std::array <double, static_cast <int>(FramePhase::Count)> phase99th;
+    double meanDrawCallCount;
+};
+
+/*
+ * Times the phases of every frame and keeps the latest frames in a ring buffer
+ *
+ * Only the thread of the main loop writes, and it never waits:
+ * the oldest frames are overwritten, and every slot has a sequence number,
+ * so a reader on another thread skips the slots being overwritten instead of locking them
+ */
+class FrameProfiler
+{
+    public:
+        static constexpr int m_phaseCount = static_cast <int>(FramePhase::Count);
+
+        FrameProfiler();
+        virtual ~FrameProfiler();
+
+        // A phase lasts from the end of the previous one or from the start of the frame
+        void beginFrame();
+        void endPhase(const FramePhase);
+        void endFrame(const int);
+
+        // The sum of the phases of the frame ended last, until the next one begins
+        std::uint32_t getLastFrameMicroseconds() const;
+
+        // The latest frames, at most the given number of them, oldest first
+        void getSamples(std::vector <FrameSample>&, const int) const;
+
+        // The frame percentiles count only the frames that have drawn something,
+        // the phase percentiles count all of them, so slow events of idle frames show too
+        FrameStatistics getStatistics(const int) const;
+
+        // All the frames kept, one per line
+        void writeCsv(const std::string&) const;
+
+        static const char* getName(const FramePhase);
+
+    private:
+        // About two minutes at 30 frames a second
+        static constexpr int m_capacity = 4096;
+
+        // An odd sequence number marks a slot being written, and 2 * frame + 2 marks the written frame
+        struct Slot
+        {
+            std::atomic <std::uint64_t> sequence {0};
+            std::array <std::atomic <std::uint32_t>, m_phaseCount + 1> values {};
+        };
+
+        std::unique_ptr <Slot[]> m_slots;
+        std::atomic <std::uint64_t> m_frameCount;
+
+        std::chrono::steady_clock::time_point m_phaseStart;
+        std::array <std::uint32_t, m_phaseCount> m_phaseMicroseconds;
+
+        bool readSlot(const std::uint64_t, FrameSample&) const;
+};
+
+#endif // FRAMEPROFILER_HPP
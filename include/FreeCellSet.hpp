@@ -0,0 +1,111 @@
+#ifndef FREECELLSET_HPP
+#define FREECELLSET_HPP
+
+#include "Tile.hpp"
+#include "Board.hpp"
+
+#include <vector>
+
+/*
+ * Keeps the indices of empty cells in a dense array
+ * together with the position of every cell in that array
+ *
+ * A cell is added to the end and removed by moving the last cell into its place,
+ * so both take constant time, and a random empty cell is just a random position
+ */
+class FreeCellSet
+{
+    public:
+        FreeCellSet();
+        virtual ~FreeCellSet();
+
+        void rebuild(const Board&);
+
+        // Takes the empty cells in the given order, e.g. the one of a saved game,
+        // they must be exactly the empty cells of the tilemap
+        void rebuild(const Board&, const std::vector <int>&);
+
+        void insert(const int);
+        void erase(const int);
+
+        // Moves the last cell to the given position and the cell there to the end,
+        // after an insert of the cell erased from that position it undoes the erase exactly
+        void moveLastTo(const int);
+
+        bool contains(const int) const;
+
+        // The position of the cell in the dense array, -1 if it is not empty
+        int getPosition(const int) const;
+        int getCount() const;
+
+        // The cell at the given position of the dense array
+        int operator[](const int) const;
+
+        // The whole dense array, its order decides which cell a random position gives
+        const std::vector <int>& getCells() const;
+
+    private:
+        std::vector <int> m_cells;
+        std::vector <int> m_positions;
+};
+
+/*
+ * The set changes on every move, so the changes are kept here to be inlined
+ */
+
+inline void FreeCellSet::insert(const int index)
+{
+    m_positions[index] = static_cast <int>(m_cells.size());
+    m_cells.push_back(index);
+}
+
+inline void FreeCellSet::erase(const int index)
+{
+    const auto position = m_positions[index];
+    const auto last = m_cells.back();
+
+    m_cells[position] = last;
+    m_positions[last] = position;
+
+    m_cells.pop_back();
+    m_positions[index] = -1;
+}
+
+inline void FreeCellSet::moveLastTo(const int position)
+{
+    const auto last = m_cells.back();
+    const auto moved = m_cells[position];
+
+    m_cells[position] = last;
+    m_positions[last] = position;
+
+    m_cells.back() = moved;
+    m_positions[moved] = static_cast <int>(m_cells.size()) - 1;
+}
+
+inline bool FreeCellSet::contains(const int index) const
+{
+    return m_positions[index] != -1;
+}
+
+inline int FreeCellSet::getPosition(const int index) const
+{
+    return m_positions[index];
+}
+
+inline int FreeCellSet::getCount() const
+{
+    return static_cast <int>(m_cells.size());
+}
+
+inline int FreeCellSet::operator[](const int position) const
+{
+    return m_cells[position];
+}
+
+inline const std::vector <int>& FreeCellSet::getCells() const
+{
+    return m_cells;
+}
+
+#endif // FREECELLSET_HPP
@@ -2,32 +2,156 @@
 #define GAMEENGINE_HPP
 
 #include "Tile.hpp"
+#include "Move.hpp"
+#include "Board.hpp"
+#include "PassableRegions.hpp"
+#include "PathFinder.hpp"
+#include "FreeCellSet.hpp"
 #include "RandomNumberGenerator.hpp"
+#include "ReplayRecorder.hpp"
+
+#ifdef COLORLINES_BITBOARD_STREAKS
+#include "ColorBitBoards.hpp"
+#endif
 
 #include <vector>
-#include <queue>
+#include <span>
 #include <algorithm>
 
+class Logger;
+
+// Rows [top, bottom) and columns [left, right) of the tilemap
+struct TileRectangle
+{
+    int top;
+    int left;
+    int bottom;
+    int right;
+
+    bool isEmpty() const
+    {
+        return (top >= bottom || left >= right);
+    }
+};
+
 class GameEngine
 {
     public:
+        static constexpr int m_minSizeInTiles = 5;
+        static constexpr int m_maxSizeInTiles = 4096;
+
+        // Views of the tilemap update it by square chunks of tiles
+        static constexpr int m_chunkSizeInTiles = 32;
+
         GameEngine();
         virtual ~GameEngine();
 
+        // Makes the following games reproducible, otherwise they depend on the time of start
+        void setRandomSeed(const std::uint64_t);
+        void setRandomAlgorithm(const RandomNumberGenerator::Algorithm);
+
+        RandomNumberGenerator::State getRandomState() const;
+        void setRandomState(const RandomNumberGenerator::State&);
+
+        // Every following game is recorded until the recorder is replaced or removed with nullptr
+        // The current game is ended on the previous recorder, which must live until then
+        void setReplayRecorder(ReplayRecorder*);
+
+        // Events of the following moves and games are logged until the logger is removed with nullptr
+        void setLogger(Logger*);
+
+        // Throws std::runtime_error if the size is out of the limits above or the number of colors is not from 1 to 8
         void startNewGame(const int, const int, const int);
+
+        /*
+         * A snapshot keeps everything needed to continue the game: the tilemap, the selection, the state,
+         * the score, the time and the generator, but not the moves that can be taken back
+         *
+         * It starts with a 64-byte little-endian header: the "CLSN" signature, the format version,
+         * the width and the height, the number of colors, the state, the flags, the algorithm of the generator,
+         * the minimal length of a streak, the score, the time, the selection and the four words of the generator
+         * Then the tiles follow as they lie in memory, one byte each, including the frame,
+         * and the empty cells as four-byte indices in the order the new balls choose them,
+         * so a loaded game goes on exactly as the saved one would
+         */
+        std::size_t getSnapshotSize() const;
+
+        // Returns the size of the snapshot, throws std::runtime_error if the buffer is smaller
+        std::size_t save(std::span <unsigned char>) const;
+
+        // The current game ends, the loaded one is not recorded, as a replay starts from an empty tilemap
+        // Throws std::runtime_error and leaves the engine as it was if the bytes are not a valid snapshot
+        void load(std::span <const unsigned char>);
+
+        // Copies the position of the other engine without its moves to take back, which grow with its game,
+        // e.g. for a search that takes back only its own moves
+        // The recorder and the logger stay as they were, and the memory of the engine is reused
+        void copyPosition(const GameEngine&);
         void processPick(const int, const int);
         void increaseTimer();
         bool isGameOver() const;
+        bool isMovePossible(const Move&) const;
+
+        // The row and the column of the selected ball, (-1, -1) if no ball is selected
+        std::pair <int, int> getSelection() const;
+
+        // The cells of the shortest path of the ball from the source to the destination, both included,
+        // the buffer is cleared first
+        // The search keeps its memory between the calls and allocates only for paths longer than all before,
+        // so it is cheap enough for every move of a bot
+        // Returns false if the move is not possible
+        bool findPath(const Move&, std::vector <std::pair <int, int>>&) const;
+
+        // Every possible move ordered by source and then by destination, the buffer is cleared first
+        void generateMoves(std::vector <Move>&) const;
+
+        // Makes a move without the picks, a selected ball is deselected first
+        // Returns false if the move is not possible
+        bool applyMove(const Move&);
+
+        // Take back the last move or make the last taken back move again, a selected ball is deselected first
+        // Return false if there is no such move
+        bool undo();
+        bool redo();
+        bool canUndo() const;
+        bool canRedo() const;
+
+        const Board& getTileMap() const;
+
+        // Changes whenever any tile changes, so views of the tilemap know when to update
+        std::uint64_t getTileMapVersion() const;
+
+        // Changes only when a move, an undo or a redo is completed or another game is started or loaded,
+        // unlike the version of the tilemap it stays the same over the picks
+        std::uint64_t getPositionVersion() const;
 
-        const std::vector <std::vector <Tile>>& getTileMap() const;
+        // Zobrist hash of the balls and the expected balls, equal positions have equal hashes
+        // A selected ball is hashed as the same ball without selection
+        std::uint64_t getHash() const;
+
+        // The smallest rectangle containing all the tiles changed since the last clearing
+        const TileRectangle& getDirtyRegion() const;
+
+        // The chunks containing the tiles changed since the last clearing, every chunk once
+        // Chunks are numbered row by row
+        const std::vector <int>& getDirtyChunks() const;
+        int getChunkCountInRow() const;
+        TileRectangle getChunkRectangle(const int) const;
+
+        // Clears the dirty chunks too
+        void clearDirtyRegion();
         int getTimeInSeconds() const;
         int getScore() const;
+        int getFreeCellCount() const;
         int getColorCount() const;
         int getTileMapWidth() const;
         int getTileMapHeight() const;
         int getState() const;
 
     private:
+        // The benchmarks measure the private steps of a move on their own
+        friend class GameEngineBenchmark;
+
         enum class GameState
         {
             FirstPick,
@@ -35,7 +159,51 @@ class GameEngine
             GameOver
         };
 
-        std::vector <std::vector <Tile>> m_tileMap;
+        // A tile changed by a move
+        // A cell that stops being empty keeps its position among the free cells, so the undo puts it back there
+        struct TileChange
+        {
+            int index;
+            Tile oldTile;
+            Tile newTile;
+            int freeCellPosition;
+        };
+
+        /*
+         * Everything a move changes besides the tiles
+         * The tiles of the move are the changes since the end of the previous move
+         */
+        struct MoveRecord
+        {
+            int changeEnd;
+            int oldScore;
+            int newScore;
+            GameState newState;
+            bool wasAdditionalMoveAvailable;
+            bool isAdditionalMoveAvailable;
+            RandomNumberGenerator::State oldRandomState;
+            RandomNumberGenerator::State newRandomState;
+        };
+
+        Board m_tileMap;
+        std::uint64_t m_tileMapVersion;
+        std::uint64_t m_positionVersion;
+        std::uint64_t m_hash;
+        TileRectangle m_dirtyRegion;
+        std::vector <int> m_dirtyChunks;
+        std::vector <bool> m_isChunkDirty;
+        int m_chunkCountInRow;
+        PassableRegions m_passableRegions;
+
+        // The regions answer whether a path exists, the search is needed only for the path itself
+        mutable PathFinder m_pathFinder;
+        mutable std::vector <int> m_pathCells;
+        FreeCellSet m_freeCells;
+
+        // Transforming visits only the cells of the expected balls instead of the whole tilemap
+        std::vector <int> m_expectedCells;
+        std::vector <int> m_transformedCells;
+
         std::pair <int, int> m_selection;
         GameState m_state;
 
@@ -48,32 +216,75 @@ class GameEngine
 
         RandomNumberGenerator m_random;
 
+        // Copies of the engine, e.g. the ones the searches play on, are never recorded nor logged
+        template <typename T>
+        struct UncopiedPointer
+        {
+            T* pointer = nullptr;
+
+            UncopiedPointer() = default;
+            UncopiedPointer(const UncopiedPointer&) {}
+        };
+
+        UncopiedPointer <ReplayRecorder> m_replay;
+        UncopiedPointer <Logger> m_logger;
+
+        // Passable cells grouped by region, filled by every move generation
+        mutable std::vector <int> m_cellRegions;
+        mutable std::vector <int> m_regionStarts;
+        mutable std::vector <int> m_regionCells;
+
+        // The moves after the first m_undoCount ones have been taken back and can be made again
+        std::vector <MoveRecord> m_history;
+        std::vector <TileChange> m_changes;
+        int m_undoCount;
+        bool m_isRecording;
+
+#ifdef COLORLINES_BITBOARD_STREAKS
+        ColorBitBoards m_ballBitBoards;
+#endif
+
         const int m_newBallCountOnMove;
 
+        void endRecordedGame();
+        bool isRecorded() const;
+        void rebuildTileMapState();
+        static void validateSnapshot(std::span <const unsigned char>, std::vector <int>&);
         void selectTile(const int, const int);
         void deselectTile();
-        void swapSelectedWith(const int, const int);
+        void makeMove(const int, const int);
+        int getChangeBegin(const int) const;
+        void setTile(const int, const Tile);
+        void markDirty(const int);
+        static std::uint64_t getTileKey(const int, const Tile);
+
+        static void putInteger(unsigned char*, const std::uint64_t, const int);
+        static std::uint64_t getInteger(const unsigned char*, const int);
 
         int addExpectedBalls(const int);
         void transformExpectedBalls();
 
         bool isTilePassable(const Tile) const;
-        bool pathExists(const int, const int, const int, const int) const;
+        bool pathExists(const int, const int) const;
 
-        int deleteStreaks(const int, const int);
+        int deleteStreaks(const int);
+        void logStreak(const int, const Tile, const int) const;
         void increaseScore(const int);
 
-        bool isHorizontalStreak(const int, const int) const;
-        int deleteAdjacentHorizontalStreak(const int, const int);
+        int getStreakLength(const int, const int) const;
+        int deleteAdjacentStreak(const int, const int);
+
+        bool isHorizontalStreak(const int) const;
+        int deleteAdjacentHorizontalStreak(const int);
 
-        bool isVerticalStreak(const int, const int) const;
-        int deleteAdjacentVerticalStreak(const int, const int);
+        bool isVerticalStreak(const int) const;
+        int deleteAdjacentVerticalStreak(const int);
 
-        bool isMainDiagonalStreak(const int, const int) const;
-        int deleteAdjacentMainDiagonalStreak(const int, const int);
+        bool isMainDiagonalStreak(const int) const;
+        int deleteAdjacentMainDiagonalStreak(const int);
 
-        bool isAntiDiagonalStreak(const int, const int) const;
-        int deleteAdjacentAntiDiagonalStreak(const int, const int);
+        bool isAntiDiagonalStreak(const int) const;
+        int deleteAdjacentAntiDiagonalStreak(const int);
 };
 
 #endif // GAMEENGINE_HPP
@@ -0,0 +1,29 @@
+#ifndef GREEDYMOVEPOLICY_HPP
+#define GREEDYMOVEPOLICY_HPP
+
+#include "MovePolicy.hpp"
+#include "RandomNumberGenerator.hpp"
+
+/*
+ * Moves a ball to the cell with the most balls of the same color around it
+ * Equally good moves are chosen randomly
+ *
+ * It does not look ahead, so it is a cheap baseline for other policies
+ */
+class GreedyMovePolicy : public MovePolicy
+{
+    public:
+        GreedyMovePolicy();
+        virtual ~GreedyMovePolicy();
+
+        bool chooseMove(const GameEngine&, Move&) override;
+        void setSeed(const std::uint64_t) override;
+
+    private:
+        std::vector <Move> m_moves;
+        RandomNumberGenerator m_random;
+
+        int countSameNeighbours(const Board&, const Move&) const;
+};
+
+#endif // GREEDYMOVEPOLICY_HPP
@@ -0,0 +1,188 @@
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+enum class EngineCounter : int
+{
+    PathExistsCalls,
+    PathExistsNeighbours,
+    PathSearchCells,
+    RegionUpdates,
+    RegionRebuilds,
+    RegionSplitChecks,
+    RegionSearchCells,
+    RegionRelabelCells,
+    HorizontalStreakChecks,
+    HorizontalStreaks,
+    VerticalStreakChecks,
+    VerticalStreaks,
+    MainDiagonalStreakChecks,
+    MainDiagonalStreaks,
+    AntiDiagonalStreakChecks,
+    AntiDiagonalStreaks,
+    BallsDeleted,
+    ExpectedBallsAdded,
+    RandomRejections,
+    BallsTransformed,
+    Count
+};
+
+enum class EngineTimer : int
+{
+    MakeMove,
+    PathExists,
+    FindPath,
+    RegionUpdate,
+    HorizontalStreak,
+    VerticalStreak,
+    MainDiagonalStreak,
+    AntiDiagonalStreak,
+    BitBoardStreaks,
+    AddExpectedBalls,
+    TransformExpectedBalls,
+    Count
+};
+
+/*
+ * Counters and timers of the steps of the engine inside real games
+ *
+ * They are gathered only if the engine is built with COLORLINES_INSTRUMENTATION,
+ * otherwise the macros below are empty and the engine has no trace of them
+ *
+ * Every thread adds to its own block without atomic read-modify-write,
+ * and the blocks are summed only when a report is asked for
+ * Times are in ticks of the processor's time stamp counter and include nested timers,
+ * e.g. the streaks found by transforming the expected balls are counted in both
+ */
+class Instrumentation
+{
+    public:
+        static constexpr int m_counterCount = static_cast <int>(EngineCounter::Count);
+        static constexpr int m_timerCount = static_cast <int>(EngineTimer::Count);
+
+        struct Report
+        {
+            bool isEnabled;
+            int threadCount;
+            double ticksPerSecond;
+            std::array <std::uint64_t, m_counterCount> counters;
+            std::array <std::uint64_t, m_timerCount> timerCalls;
+            std::array <std::uint64_t, m_timerCount> timerTicks;
+        };
+
+        static constexpr bool isEnabled()
+        {
+#ifdef COLORLINES_INSTRUMENTATION
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        static void add(const EngineCounter, const std::uint64_t);
+        static void addTime(const EngineTimer, const std::uint64_t);
+        static std::uint64_t getTicks();
+
+        // Sums the blocks of all threads, including the finished ones
+        static Report collect();
+        static void reset();
+
+        static std::string toJson(const Report&);
+        static std::string toPrometheus(const Report&);
+
+        static const char* getName(const EngineCounter);
+        static const char* getName(const EngineTimer);
+
+    private:
+        // Only the owner thread writes, so relaxed loads and stores are enough
+        struct alignas(64) Block
+        {
+            std::array <std::atomic <std::uint64_t>, m_counterCount> counters {};
+            std::array <std::atomic <std::uint64_t>, m_timerCount> timerCalls {};
+            std::array <std::atomic <std::uint64_t>, m_timerCount> timerTicks {};
+        };
+
+        // Keeps the blocks of all threads, defined with the functions
+        struct Registry;
+
+        static Registry& getRegistry();
+        static Block& getBlock();
+
+        static void increase(std::atomic <std::uint64_t>&, const std::uint64_t);
+};
+
+/*
+ * Adds the ticks from its creation to its destruction to the timer
+ */
+class ScopedTimer
+{
+    public:
+        ScopedTimer(const EngineTimer);
+        ~ScopedTimer();
+
+    private:
+        EngineTimer m_timer;
+        std::uint64_t m_start;
+};
+
+#ifdef COLORLINES_INSTRUMENTATION
+#define COLORLINES_COUNT(counter, count) Instrumentation::add(EngineCounter::counter, (count))
+#define COLORLINES_TIME(timer) ScopedTimer scopedTimer##timer(EngineTimer::timer)
+#else
+#define COLORLINES_COUNT(counter, count) ((void)0)
+#define COLORLINES_TIME(timer) ((void)0)
+#endif
+
+/*
+ * Timers wrap functions of a few nanoseconds, so the hot parts are kept here to be inlined
+ */
+
+inline void Instrumentation::increase(std::atomic <std::uint64_t>& value, const std::uint64_t count)
+{
+    value.store(value.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+}
+
+inline void Instrumentation::add(const EngineCounter counter, const std::uint64_t count)
+{
+    increase(getBlock().counters[static_cast <int>(counter)], count);
+}
+
+inline void Instrumentation::addTime(const EngineTimer timer, const std::uint64_t ticks)
+{
+    auto& block = getBlock();
+    increase(block.timerCalls[static_cast <int>(timer)], 1);
+    increase(block.timerTicks[static_cast <int>(timer)], ticks);
+}
+
+// Other processors fall back to nanoseconds
+inline std::uint64_t Instrumentation::getTicks()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast <std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+inline ScopedTimer::ScopedTimer(const EngineTimer timer) : m_timer(timer), m_start(Instrumentation::getTicks())
+{
+    //ctor
+}
+
+inline ScopedTimer::~ScopedTimer()
+{
+    Instrumentation::addTime(m_timer, Instrumentation::getTicks() - m_start);
+}
+
+#endif // INSTRUMENTATION_HPP
@@ -3,18 +3,188 @@
 
 #include "GameEngine.hpp"
 
+#include <array>
+#include <atomic>
+#include <memory>
 #include <string>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
 #include <stdexcept>
-#include <fstream>
-#include <iomanip>
 
+enum class LogLevel : std::uint8_t
+{
+    Debug,
+    Info,
+    Warning,
+    Error,
+    Count
+};
+
+enum class LogEvent : std::uint8_t
+{
+    GameStarted,
+    Move,
+    Spawn,
+    StreakCleared,
+    GameOver,
+    FrameStall,
+    Error,
+    AutosaveFailed,
+    Count
+};
+
+// The meaning of the values depends on the event, Logger::getFieldNames tells it
+using LogValues = std::array <std::int32_t, 5>;
+
+struct LogRecord
+{
+    // Nanoseconds since the start of the logger
+    std::int64_t time;
+    LogEvent event;
+    LogLevel level;
+    std::uint16_t thread;
+    LogValues values;
+};
+
+/*
+ * Writes the events of games and frames into a binary file on a thread of its own
+ *
+ * Producers on any thread put fixed-size records into a bounded lock-free ring and never wait:
+ * a record that finds the ring full is dropped and counted
+ * The writer thread takes the records in batches and rotates the file when it grows too big:
+ * the file becomes FILE.1, the older ones move one number up, and the oldest one is deleted
+ * The file of the previous run is rotated away at start
+ *
+ * Every file starts with a 24-byte little-endian header: the "CLLG" signature, the format version,
+ * the size of a record and the wall clock time of the start of the logger in nanoseconds since the epoch
+ * Then 32-byte records follow: the time, the event, the level, the thread and the five values
+ */
 class Logger
 {
     public:
-        Logger();
+        // The path, the lowest level written, the size a file is rotated at and the number of old files kept
+        // Throws std::runtime_error if the file cannot be created
+        Logger(const std::string&, const LogLevel, const std::uint64_t, const int);
+
+        // Writes the records left, the producers must have stopped
         virtual ~Logger();
 
+        void setLevel(const LogLevel);
+        bool isEnabled(const LogLevel) const;
+
+        // Never blocks and never allocates
+        void write(const LogLevel, const LogEvent, const LogValues&);
+
+        // A failure may end the game, so the reason and the board are written into error.log next to the log at once
         void writeError(const GameEngine&, const std::exception&);
+
+        std::uint64_t getDroppedCount() const;
+
+        // Reads a file written by a logger, the second argument gets the wall clock time of its start
+        static std::vector <LogRecord> readFile(const std::string&, std::int64_t&);
+
+        static const char* getName(const LogLevel);
+        static const char* getName(const LogEvent);
+
+        // Unused values have null names
+        static const std::array <const char*, 5>& getFieldNames(const LogEvent);
+
+    private:
+        static constexpr std::uint64_t m_capacity = 1 << 14;
+        static constexpr int m_headerSize = 24;
+        static constexpr int m_recordSize = 32;
+        static constexpr std::uint32_t m_version = 1;
+
+        // A slot is free for the record number equal to its sequence, and holds it when the sequence is one more
+        struct Slot
+        {
+            std::atomic <std::uint64_t> sequence;
+            LogRecord record;
+        };
+
+        std::unique_ptr <Slot[]> m_slots;
+        alignas(64) std::atomic <std::uint64_t> m_tail;
+        alignas(64) std::uint64_t m_head;
+
+        std::atomic <std::uint64_t> m_droppedCount;
+        std::atomic <LogLevel> m_level;
+        std::atomic <bool> m_isRunning;
+
+        const std::chrono::steady_clock::time_point m_startTime;
+        const std::int64_t m_startWallTime;
+
+        const std::string m_path;
+        const std::uint64_t m_maxFileSize;
+        const int m_keptFileCount;
+
+        std::unique_ptr <std::FILE, int (*)(std::FILE*)> m_file;
+        std::uint64_t m_fileSize;
+        std::vector <unsigned char> m_batch;
+
+        // Started last, when everything it uses is ready
+        std::thread m_thread;
+
+        bool read(LogRecord&);
+        void run();
+        void writeBatch();
+        void rotate();
+
+        static std::uint16_t getThreadIndex();
+
+        static void putInteger(unsigned char*, const std::uint64_t, const int);
+        static std::uint64_t getInteger(const unsigned char*, const int);
 };
 
+/*
+ * Producers call these on every event, so they are kept here to be inlined
+ */
+
+inline bool Logger::isEnabled(const LogLevel level) const
+{
+    return level >= m_level.load(std::memory_order_relaxed);
+}
+
+/*
+ * A producer claims the next record number with a compare-and-swap,
+ * fills the slot and publishes it with the new sequence
+ */
+inline void Logger::write(const LogLevel level, const LogEvent event, const LogValues& values)
+{
+    if (!isEnabled(level))
+        return;
+
+    const auto time = std::chrono::duration_cast <std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTime).count();
+    auto position = m_tail.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        auto& slot = m_slots[position % m_capacity];
+        const auto sequence = slot.sequence.load(std::memory_order_acquire);
+
+        if (sequence == position)
+        {
+            // On failure 'position' is reloaded
+            if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                slot.record = LogRecord {time, event, level, getThreadIndex(), values};
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return;
+            }
+        }
+        else if (sequence < position)
+        {
+            // The writer has not freed the slot yet, so the ring is full
+            m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            position = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
 #endif // LOGGER_HPP
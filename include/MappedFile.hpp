@@ -0,0 +1,39 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <string>
+#include <cstddef>
+#include <stdexcept>
+
+/*
+ * A whole file mapped into memory for reading
+ *
+ * Pages are loaded by the system when they are touched,
+ * so reading a few records of a huge file costs a few pages
+ */
+class MappedFile
+{
+    public:
+        MappedFile(const std::string&);
+        virtual ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // An empty file has no data
+        const unsigned char* getData() const;
+        size_t getSize() const;
+
+    private:
+        const unsigned char* m_data;
+        size_t m_size;
+
+#ifdef _WIN32
+        void* m_file;
+        void* m_mapping;
+#else
+        int m_descriptor;
+#endif
+};
+
+#endif // MAPPEDFILE_HPP
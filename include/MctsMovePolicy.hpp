@@ -0,0 +1,117 @@
+#ifndef MCTSMOVEPOLICY_HPP
+#define MCTSMOVEPOLICY_HPP
+
+#include "MovePolicy.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include <atomic>
+#include <memory>
+#include <chrono>
+
+struct MctsResult
+{
+    Move bestMove;
+
+    // The most visited moves from the root of the first tree
+    std::vector <Move> principalVariation;
+
+    // The mean reward of the best move
+    float value;
+    std::int64_t playoutCount;
+    int nodeCount;
+};
+
+/*
+ * Chooses moves by Monte Carlo tree search
+ *
+ * A node of a tree is a sequence of our moves, not a position: every playout draws its own random balls,
+ * so a node stands for all the positions its moves can lead to, and its children that are not possible
+ * in the position of the current playout are skipped
+ * A playout goes down the tree by UCT, adds the children of the last node once it has been visited,
+ * and then plays random or greedy moves with the rules of the engine, the reward is the score gained
+ * plus a little for every free cell at the end
+ *
+ * The threads are divided among several trees, each tree is shared by its threads without locks:
+ * 1. a thread that goes through a node adds a virtual loss to it, so the other threads prefer other nodes;
+ * 2. the children of a node are added by the thread that marks the node first,
+ *    the others do a playout from the node meanwhile
+ * The visits of the root moves of all the trees are summed to choose the move
+ */
+class MctsMovePolicy : public MovePolicy
+{
+    public:
+        MctsMovePolicy();
+        virtual ~MctsMovePolicy();
+
+        bool chooseMove(const GameEngine&, Move&) override;
+        void setSeed(const std::uint64_t) override;
+
+        // The search stops when either of the budgets is spent, zero means no limit
+        // With one thread and no time limit the search gives the same move for the same seed
+        void setTimeBudget(const std::chrono::milliseconds);
+        void setPlayoutBudget(const std::int64_t);
+
+        void setThreadCount(const int);
+        void setTreeCount(const int);
+        void setNodeLimit(const int);
+
+        void setPlayoutLength(const int);
+        void setGreedyPlayouts(const bool);
+        void setExplorationFactor(const float);
+
+        // Returns false if there is no possible move
+        bool search(const GameEngine&, MctsResult&);
+
+    private:
+        struct Node
+        {
+            Move move;
+            std::atomic <int> visitCount;
+            std::atomic <int> virtualLossCount;
+            std::atomic <double> totalReward;
+
+            // The children are published by the release of the state, so they are plain fields
+            int firstChild;
+            int childCount;
+            std::atomic <int> state;
+        };
+
+        enum NodeState
+        {
+            Unexpanded,
+            Expanding,
+            Expanded,
+            Full
+        };
+
+        struct Tree
+        {
+            std::unique_ptr <Node[]> nodes;
+            std::atomic <int> nodeCount;
+        };
+
+        std::uint64_t m_seed;
+        std::chrono::milliseconds m_timeBudget;
+        std::int64_t m_playoutBudget;
+        int m_threadCount;
+        int m_treeCount;
+        int m_nodeLimit;
+        int m_playoutLength;
+        bool m_isGreedyPlayout;
+        float m_explorationFactor;
+
+        std::vector <std::unique_ptr <Tree>> m_trees;
+        std::chrono::steady_clock::time_point m_deadline;
+        std::atomic <std::int64_t> m_playoutCount;
+        std::atomic <bool> m_isStopped;
+
+        void prepareTrees();
+        void initializeNode(Node&, const Move&);
+        bool expandNode(Tree&, Node&, const GameEngine&, std::vector <Move>&, std::vector <std::pair <int, int>>&);
+        int selectChild(const Tree&, const Node&, const GameEngine&, const double) const;
+
+        void work(const GameEngine&, const int);
+        bool chooseRandomMove(const GameEngine&, RandomNumberGenerator&, std::vector <Move>&, Move&) const;
+};
+
+#endif // MCTSMOVEPOLICY_HPP
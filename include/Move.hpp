@@ -0,0 +1,15 @@
+#ifndef MOVE_HPP
+#define MOVE_HPP
+
+/*
+ * A move of a ball from one cell to another
+ */
+struct Move
+{
+    int sourceRow;
+    int sourceColumn;
+    int destinationRow;
+    int destinationColumn;
+};
+
+#endif // MOVE_HPP
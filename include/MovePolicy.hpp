@@ -0,0 +1,31 @@
+#ifndef MOVEPOLICY_HPP
+#define MOVEPOLICY_HPP
+
+#include "Move.hpp"
+#include "GameEngine.hpp"
+
+#include <vector>
+#include <cstdint>
+
+/*
+ * Decides which move to make in a position
+ * Policies are used to play games without a player, one policy object per game at a time
+ */
+class MovePolicy
+{
+    public:
+        MovePolicy();
+        virtual ~MovePolicy();
+
+        // Returns false if there is no possible move
+        virtual bool chooseMove(const GameEngine&, Move&) = 0;
+
+        // Policies that make random choices repeat them for the same seed
+        virtual void setSeed(const std::uint64_t);
+
+    protected:
+        // A cheap rating of a move for ordering, the higher the better
+        static int rateMove(const Board&, const Move&);
+};
+
+#endif // MOVEPOLICY_HPP
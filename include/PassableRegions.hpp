@@ -0,0 +1,105 @@
+#ifndef PASSABLEREGIONS_HPP
+#define PASSABLEREGIONS_HPP
+
+#include "Tile.hpp"
+#include "Board.hpp"
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <cstdlib>
+
+/*
+ * Splits passable cells of the tilemap into connected regions
+ * using a union-find forest
+ *
+ * Two passable cells are connected by a path if and only if they have the same region,
+ * so reachability queries never search the tilemap
+ *
+ * The forest is updated after every change of passability of a cell:
+ * 1. a cell that becomes passable gets a new node and joins the regions of its neighbours;
+ * 2. a cell that becomes blocked keeps its node in the forest as a dead one if its neighbours are still connected,
+ *    which the ring of cells around it or short searches usually show,
+ *    otherwise every part of the region but the last one found gets new nodes
+ *
+ * Dead nodes are never used again, so when new nodes run out the whole forest is rebuilt
+ */
+class PassableRegions
+{
+    public:
+        PassableRegions();
+        virtual ~PassableRegions();
+
+        void rebuild(const Board&);
+        void update(const Board&, const int);
+
+        // Only meaningful for passable cells, the regions are less than the count of nodes
+        int getRegion(const int) const;
+
+        // All the nodes of the forest, including the dead ones and the spare ones
+        int getNodeCount() const;
+
+        // Numbers the regions from zero in the order of their first cells and writes the number of every passable cell
+        // into the buffer, the other cells get -1
+        // Returns the number of regions, the time is proportional to the cells, whatever the count of nodes
+        int labelRegions(const Board&, std::vector <int>&) const;
+
+    private:
+        // Queries compress paths, which does not change the regions themselves
+        mutable std::vector <int> m_parents;
+        std::vector <int> m_sizes;
+
+        // The node of every cell, a cell gets a new node every time it becomes passable
+        std::vector <int> m_nodes;
+        int m_nextNode;
+
+        std::vector <std::uint32_t> m_marks;
+        std::uint32_t m_currentMark;
+        std::vector <int> m_stack;
+
+        // The numbers of the roots met by the current labelling, a root is numbered if its mark is the current one
+        mutable std::vector <int> m_rootLabels;
+        mutable std::vector <std::uint32_t> m_rootMarks;
+        mutable std::uint32_t m_currentRootMark;
+
+        // The cells reached from every neighbour of a blocked cell
+        std::array <std::vector <int>, 4> m_searches;
+
+        int m_offsets[4];
+
+        // The cells around a cell clockwise from the upper one, orthogonal neighbours at even positions
+        int m_ringOffsets[8];
+
+        int findRoot(const int) const;
+        void advanceMark(const std::uint32_t);
+        void join(const int, const int);
+        bool maySplit(const Board&, const int) const;
+        void split(const Board&, const int);
+        bool moveToNewNodes(const Board&, const bool (&)[4], const int);
+        int relabel(const Board&, const int);
+};
+
+/*
+ * Every path query asks for regions, so the query is kept here to be inlined
+ */
+
+inline int PassableRegions::getRegion(const int index) const
+{
+    return findRoot(m_nodes[index]);
+}
+
+inline int PassableRegions::findRoot(const int node) const
+{
+    auto root = node;
+    while (m_parents[root] != root)
+    {
+        // Path halving keeps the trees flat without recursion
+        m_parents[root] = m_parents[m_parents[root]];
+        root = m_parents[root];
+    }
+
+    return root;
+}
+
+#endif // PASSABLEREGIONS_HPP
@@ -0,0 +1,43 @@
+#ifndef PATHFINDER_HPP
+#define PATHFINDER_HPP
+
+#include "Tile.hpp"
+#include "Board.hpp"
+
+#include <vector>
+#include <cstdint>
+
+/*
+ * Finds the shortest path of a ball through passable cells by a breadth-first search
+ *
+ * All the memory of the search is kept between the queries and sized once for the tilemap:
+ * 1. a cell is visited if its mark equals the mark of the current search,
+ *    so a new search only increases the mark instead of clearing the grid;
+ * 2. every cell enters the queue at most once, so the queue never holds more than all the cells;
+ * 3. every visited cell keeps the cell it was reached from, the path is read back from the destination
+ *
+ * Copies start empty, the memory of a search is never worth copying
+ */
+class PathFinder
+{
+    public:
+        PathFinder();
+        PathFinder(const PathFinder&);
+        PathFinder& operator=(const PathFinder&);
+        virtual ~PathFinder();
+
+        void resize(const Board&);
+
+        // Cells from the source to the destination, both included, the buffer is cleared first
+        // The source may be a ball, the other cells of the path must be passable
+        // Returns false if there is no path
+        bool find(const Board&, const int, const int, std::vector <int>&);
+
+    private:
+        std::vector <std::uint32_t> m_marks;
+        std::uint32_t m_currentMark;
+        std::vector <int> m_queue;
+        std::vector <int> m_parents;
+};
+
+#endif // PATHFINDER_HPP
@@ -0,0 +1,24 @@
+#ifndef RANDOMMOVEPOLICY_HPP
+#define RANDOMMOVEPOLICY_HPP
+
+#include "MovePolicy.hpp"
+#include "RandomNumberGenerator.hpp"
+
+/*
+ * Makes any possible move with equal probability
+ */
+class RandomMovePolicy : public MovePolicy
+{
+    public:
+        RandomMovePolicy();
+        virtual ~RandomMovePolicy();
+
+        bool chooseMove(const GameEngine&, Move&) override;
+        void setSeed(const std::uint64_t) override;
+
+    private:
+        std::vector <Move> m_moves;
+        RandomNumberGenerator m_random;
+};
+
+#endif // RANDOMMOVEPOLICY_HPP
@@ -2,21 +2,157 @@
 #define RANDOMNUMBERGENERATOR_HPP
 
 #include "Tile.hpp"
+#include "Instrumentation.hpp"
 
 #include <chrono>
 #include <random>
+#include <memory>
+#include <array>
+#include <bit>
+#include <cstdint>
 
+/*
+ * Gives random numbers for the engine and the policies
+ *
+ * There is a choice of three generators:
+ * 1. xoshiro256** is the default one, it is fast and has 32 bytes of state;
+ * 2. PCG32 has 16 bytes of state;
+ * 3. mt19937 is the standard one, its 5 KB of state are allocated only when it is chosen
+ *
+ * Bounded integers use Lemire's multiply-and-shift method,
+ * which has no bias and needs a division only in rare cases
+ */
 class RandomNumberGenerator
 {
     public:
+        enum class Algorithm : std::uint8_t
+        {
+            Xoshiro256StarStar,
+            Pcg32,
+            MersenneTwister
+        };
+
+        /*
+         * Everything needed to continue the same sequence later
+         * mt19937 is restored by replaying its sequence from the seed,
+         * so it takes time proportional to the count of numbers drawn
+         */
+        struct State
+        {
+            Algorithm algorithm;
+            std::array <std::uint64_t, 4> words;
+        };
+
         RandomNumberGenerator();
+        RandomNumberGenerator(const Algorithm);
+        RandomNumberGenerator(const RandomNumberGenerator&);
+        RandomNumberGenerator& operator=(const RandomNumberGenerator&);
         virtual ~RandomNumberGenerator();
 
+        // Changing the algorithm keeps the last seed
+        void setAlgorithm(const Algorithm);
+        Algorithm getAlgorithm() const;
+
+        void setSeed(const std::uint64_t);
+
+        // The state of xoshiro and PCG carries no seed, so a generator set to such a state has none
+        // and the seed it reports is only the last one it was given
+        bool hasSeed() const;
+        std::uint64_t getSeed() const;
+
+        // True if no number has been drawn since the last seeding, so the seed alone restores the state
+        bool isAtSeed() const;
+
+        State getState() const;
+        void setState(const State&);
+
+        // Derives independent seeds from one master seed, e.g. one for every game of a batch
+        static std::uint64_t mixSeed(const std::uint64_t, const std::uint64_t);
+
         int getInteger(const int, const int);
         Tile getTile(const Tile, const Tile);
 
     private:
-        std::mt19937 m_engine;
+        Algorithm m_algorithm;
+        std::uint64_t m_seed;
+        bool m_hasSeed;
+
+        // xoshiro256** keeps all four words, PCG32 keeps its state and increment,
+        // and mt19937 keeps the number of values drawn since seeding
+        std::array <std::uint64_t, 4> m_words;
+        std::unique_ptr <std::mt19937> m_mersenneTwister;
+
+        std::uint32_t getNext();
 };
 
+/*
+ * Numbers are drawn for every new ball, so drawing is kept here to be inlined
+ */
+
+inline std::uint32_t RandomNumberGenerator::getNext()
+{
+    switch (m_algorithm)
+    {
+        case Algorithm::Xoshiro256StarStar:
+        {
+            auto& s = m_words;
+            const auto result = std::rotl(s[1] * 5, 7) * 9;
+            const auto t = s[1] << 17;
+
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = std::rotl(s[3], 45);
+
+            // The upper bits are the best ones
+            return static_cast <std::uint32_t>(result >> 32);
+        }
+
+        case Algorithm::Pcg32:
+        {
+            const auto state = m_words[0];
+            m_words[0] = state * 6364136223846793005ULL + m_words[1];
+
+            const auto xorShifted = static_cast <std::uint32_t>(((state >> 18) ^ state) >> 27);
+            const auto rotation = static_cast <int>(state >> 59);
+            return std::rotr(xorShifted, rotation);
+        }
+
+        default:
+        {
+            m_words[0]++;
+            return static_cast <std::uint32_t>((*m_mersenneTwister)());
+        }
+    }
+}
+
+/*
+ * Returns a number in [inclusiveMinValue, exclusiveMaxValue)
+ */
+inline int RandomNumberGenerator::getInteger(const int inclusiveMinValue, const int exclusiveMaxValue)
+{
+    const auto range = static_cast <std::uint32_t>(exclusiveMaxValue - inclusiveMinValue);
+
+    // The upper half of the product is uniform in [0, range)
+    // once the values of the lower half that make it uneven are rejected
+    auto product = static_cast <std::uint64_t>(getNext()) * range;
+    auto low = static_cast <std::uint32_t>(product);
+
+    if (low < range)
+    {
+        const auto threshold = (0u - range) % range;
+
+        while (low < threshold)
+        {
+            COLORLINES_COUNT(RandomRejections, 1);
+            product = static_cast <std::uint64_t>(getNext()) * range;
+            low = static_cast <std::uint32_t>(product);
+        }
+    }
+
+    return inclusiveMinValue + static_cast <int>(product >> 32);
+}
+
 #endif // RANDOMNUMBERGENERATOR_HPP
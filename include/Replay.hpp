@@ -0,0 +1,74 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include "RandomNumberGenerator.hpp"
+
+#include <vector>
+#include <cstdint>
+
+/*
+ * A replay file keeps whole games as streams of records
+ *
+ * The file starts with an 8-byte header: the "CLRP" signature and the format version
+ * Every record starts with a varint of the milliseconds since the previous record
+ * shifted left by 3 bits and the record type in the low bits, then its varint fields follow:
+ * 1. Start: the width, the height, the number of colors,
+ *    the generator shifted left by 1 bit with the low bit set if the seed alone is kept,
+ *    then the 8-byte little-endian seed or the four 8-byte words of the generator state;
+ * 2. Pick: the cell, which is 'row * width + column';
+ * 3. Move: the source cell and the destination cell;
+ * 4. Undo and Redo: nothing;
+ * 5. End: the score.
+ *
+ * A game without the end record has not been finished, e.g. the program crashed
+ */
+enum class ReplayRecordType : std::uint8_t
+{
+    Start,
+    Pick,
+    Move,
+    Undo,
+    Redo,
+    End
+};
+
+struct ReplayAction
+{
+    ReplayRecordType type;
+
+    // Milliseconds since the start of the game
+    std::int64_t time;
+
+    // Cells of a pick or of a move
+    int firstCell;
+    int secondCell;
+};
+
+struct ReplayGame
+{
+    int widthInTiles;
+    int heightInTiles;
+    int colorCount;
+
+    // The state is kept only if the generator has drawn numbers since its seeding
+    bool isSeeded;
+    std::uint64_t seed;
+    RandomNumberGenerator::State randomState;
+
+    std::vector <ReplayAction> actions;
+
+    bool isFinished;
+    int score;
+};
+
+namespace Replay
+{
+    constexpr int headerSize = 8;
+
+    // "CLRP" read as a little-endian number
+    constexpr std::uint32_t signature = 0x50524C43;
+    constexpr std::uint32_t version = 1;
+    constexpr int typeBitCount = 3;
+}
+
+#endif // REPLAY_HPP
@@ -0,0 +1,88 @@
+#ifndef REPLAYCORPUS_HPP
+#define REPLAYCORPUS_HPP
+
+#include "Replay.hpp"
+#include "ReplayReader.hpp"
+#include "MappedFile.hpp"
+#include "GameEngine.hpp"
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <functional>
+#include <cstdint>
+#include <stdexcept>
+
+// What the index keeps about a game
+struct CorpusEntry
+{
+    std::uint64_t offset;
+    std::uint64_t seed;
+    int score;
+    int actionCount;
+    int widthInTiles;
+    int heightInTiles;
+    int colorCount;
+    bool isSeeded;
+    bool isFinished;
+};
+
+/*
+ * Many replay files joined into one mapped file with an index of the games
+ *
+ * The file starts with an 8-byte header: the "CLRC" signature and the format version
+ * Then the games follow as they are in replay files, then a 32-byte little-endian entry of every game:
+ * the offset, the seed, the score, the number of actions, the width, the height,
+ * the number of colors and the flags
+ * The file ends with a 24-byte footer: the offset of the index, the number of games,
+ * the "CLRI" signature and the version again
+ *
+ * Queries read the index only, and a game is decoded only when its actions are needed
+ */
+class ReplayCorpus
+{
+    public:
+        // Maps the file and checks its footer
+        ReplayCorpus(const std::string&);
+        virtual ~ReplayCorpus();
+
+        // Joins the games of the replay files into a new corpus
+        // Returns the number of games
+        static int build(const std::string&, const std::vector <std::string>&);
+
+        int getGameCount() const;
+        CorpusEntry getEntry(const int) const;
+
+        // Indices of the games whose entries pass the filter, in the order of the file
+        std::vector <int> findGames(const std::function <bool(const CorpusEntry&)>&) const;
+
+        void readGame(const int, ReplayGame&) const;
+
+        // Copies of the engine are kept after every given number of actions of the last reconstructed game
+        void setCheckpointInterval(const int);
+
+        // The position after the given number of actions of the game,
+        // which is replayed from the nearest checkpoint before it
+        const GameEngine& getPosition(const int, const int);
+
+    private:
+        static constexpr int m_headerSize = 8;
+        static constexpr int m_entrySize = 32;
+        static constexpr int m_footerSize = 24;
+        static constexpr std::uint32_t m_version = 1;
+
+        MappedFile m_file;
+        const unsigned char* m_index;
+        int m_gameCount;
+
+        int m_checkpointInterval;
+        int m_checkpointGame;
+        ReplayGame m_game;
+        std::vector <GameEngine> m_checkpoints;
+        std::optional <GameEngine> m_position;
+
+        static void putInteger(unsigned char*, const std::uint64_t, const int);
+        static std::uint64_t getInteger(const unsigned char*, const int);
+};
+
+#endif // REPLAYCORPUS_HPP
@@ -0,0 +1,71 @@
+#ifndef REPLAYREADER_HPP
+#define REPLAYREADER_HPP
+
+#include "Replay.hpp"
+#include "GameEngine.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <stdexcept>
+
+/*
+ * Reads the games of a replay file one by one without loading the whole file,
+ * or the games kept in memory, e.g. in a mapped file
+ */
+class ReplayReader
+{
+    public:
+        // Opens the file and checks its header
+        ReplayReader(const std::string&);
+
+        // Reads the games starting at the given bytes, there is no header
+        ReplayReader(const unsigned char*, const size_t);
+        virtual ~ReplayReader();
+
+        // Returns false after the last game
+        // A record cut by the end of the file ends an unfinished game
+        bool readGame(ReplayGame&);
+
+        // Bytes [begin, end) of the last read game counted from the start of the file or the memory
+        // A cut record is not counted
+        std::uint64_t getGameBegin() const;
+        std::uint64_t getGameEnd() const;
+
+        // Plays the game from its start on the engine
+        // Returns false if a finished game ends with another score
+        static bool replayGame(GameEngine&, const ReplayGame&);
+
+        // The steps of replaying, for those who stop in the middle of a game
+        static void startGame(GameEngine&, const ReplayGame&);
+        static void applyAction(GameEngine&, const ReplayGame&, const ReplayAction&);
+
+    private:
+        static constexpr size_t m_bufferSize = 64 * 1024;
+
+        // The file is null when the games are read from memory
+        std::FILE* m_file;
+        std::vector <unsigned char> m_buffer;
+
+        // The bytes being read start at the given offset of the file
+        const unsigned char* m_data;
+        std::uint64_t m_dataOffset;
+        size_t m_position;
+        size_t m_size;
+
+        std::uint64_t m_gameBegin;
+        std::uint64_t m_gameEnd;
+
+        // The start of the next game is read with the end of the previous one
+        bool m_isStartPending;
+
+        std::uint64_t getOffset() const;
+        bool getByte(unsigned char&);
+        bool getVarint(std::uint64_t&);
+        bool getInteger(std::uint64_t&, const int);
+        bool getCell(const ReplayGame&, int&);
+        bool readStart(ReplayGame&);
+};
+
+#endif // REPLAYREADER_HPP
@@ -0,0 +1,57 @@
+#ifndef REPLAYRECORDER_HPP
+#define REPLAYRECORDER_HPP
+
+#include "Replay.hpp"
+#include "Move.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <stdexcept>
+
+/*
+ * Appends the games of an engine to a replay file
+ *
+ * Records are buffered in memory and written only between games,
+ * so recorders of different threads can share one file and their games never interleave
+ */
+class ReplayRecorder
+{
+    public:
+        // Opens the file for appending, an empty file gets the header
+        ReplayRecorder(const std::string&);
+        virtual ~ReplayRecorder();
+
+        // A started game is ended by the engine with its score
+        void startGame(const int, const int, const int, const RandomNumberGenerator&);
+        void recordPick(const int, const int);
+        void recordMove(const Move&);
+        void recordUndo();
+        void recordRedo();
+        void endGame(const int);
+        bool isGameStarted() const;
+
+        // Writes everything buffered, including an unfinished game
+        void flush();
+
+    private:
+        // Games are written when the buffer grows past this size
+        static constexpr size_t m_bufferLimit = 64 * 1024;
+
+        std::FILE* m_file;
+        std::vector <unsigned char> m_buffer;
+
+        bool m_isGameStarted;
+        int m_widthInTiles;
+        std::chrono::steady_clock::time_point m_lastRecordTime;
+
+        void putRecord(const ReplayRecordType);
+        void putVarint(std::uint64_t);
+        void putInteger(const std::uint64_t, const int);
+        bool write();
+};
+
+#endif // REPLAYRECORDER_HPP
@@ -2,41 +2,48 @@
 #define RESOURCEMANAGER_HPP
 
 #include "Tile.hpp"
+#include "AssetBundle.hpp"
 
 #include <SFML/Graphics/Texture.hpp>
-#include <SFML/Graphics/Sprite.hpp>
 #include <SFML/Graphics/Font.hpp>
-
-#include <string>
-#include <map>
-
+#include <SFML/Graphics/Rect.hpp>
+
+#include <array>
+#include <stdexcept>
+
+/*
+ * All the sprites are packed into one texture atlas,
+ * so the whole tilemap is drawn with a single texture
+ *
+ * Every kind of tile has its own slot in the atlas, the slot of an empty tile holds the cell,
+ * and the expected and selected balls are stored already scaled
+ *
+ * The atlas and the font are packed into the game at build time,
+ * so loading reads no files and decodes no images, and the game starts from any directory
+ */
 class ResourceManager
 {
     public:
         ResourceManager();
         ~ResourceManager();
 
-        void loadFont();
-        void loadSprites();
+        // Uploads the atlas and opens the font compiled into the game
+        void load();
+
+        const sf::Texture& getAtlasTexture() const;
+        const sf::IntRect& getTextureRect(const Tile) const;
 
-        sf::Sprite getBallSprite(const Tile) const;
-        sf::Sprite getCellSprite() const;
+        // The rectangles of all the tiles indexed by the tile
+        const std::array <sf::IntRect, static_cast <int>(Tile::Count)>& getTextureRects() const;
         int getSpriteSize() const;
-        sf::Font getFont() const;
+        const sf::Font& getFont() const;
 
     private:
-        void loadSprite(sf::Texture&, sf::Sprite&, const std::string&);
-        void loadScaledSprite(const sf::Texture&, sf::Sprite&, const float);
-
         sf::Font m_font;
-        sf::Texture m_cellTexture;
-        sf::Sprite m_cellSprite;
-
-        std::map <Tile, sf::Texture> m_ballTextures;
-        std::map <Tile, sf::Sprite> m_ballSprites;
+        sf::Texture m_atlasTexture;
+        std::array <sf::IntRect, static_cast <int>(Tile::Count)> m_textureRects;
 
-        const int m_spriteSizeInPixels;
-        const std::string m_directoryName;
+        int m_spriteSizeInPixels;
 };
 
 #endif // RESOURCEMANAGER_HPP
@@ -0,0 +1,89 @@
+#ifndef RESULTFILE_HPP
+#define RESULTFILE_HPP
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <stdexcept>
+
+struct GameRecord
+{
+    std::uint64_t seed;
+    std::int32_t score;
+    std::int32_t moveCount;
+};
+
+/*
+ * Everything the games of a batch depend on besides their indices,
+ * so a stopped batch is resumed only with the same settings
+ */
+struct ResultHeader
+{
+    std::int32_t gameCount;
+    std::uint64_t masterSeed;
+    std::int32_t widthInTiles;
+    std::int32_t heightInTiles;
+    std::int32_t colorCount;
+    std::int32_t maxMoveCount;
+    std::int32_t randomAlgorithm;
+
+    // Zero for the games started on an empty tilemap
+    std::uint64_t startPositionHash;
+
+    // The policy with its parameters, at most 24 bytes
+    std::string policyName;
+};
+
+/*
+ * A binary file of game results
+ *
+ * The file starts with an 80-byte little-endian header:
+ * the "CLRS" signature, the format version, the record size, the number of games, the master seed,
+ * the width and the height, the number of colors, the moves after which a game is stopped,
+ * the generator, the hash of the start position and the name of the policy padded with zeros
+ * Then a 16-byte little-endian record of every game follows:
+ * the seed, the score and the number of moves
+ *
+ * The record of game 'i' always has the same offset, so every thread writes its games
+ * through its own handle without waiting for others,
+ * and the file does not depend on the number of threads
+ */
+class ResultFile
+{
+    public:
+        // Opens an existing file for writing
+        ResultFile(const std::string&);
+        virtual ~ResultFile();
+
+        // Truncates the file and writes the header
+        // Throws std::runtime_error if the name of the policy is too long
+        static void create(const std::string&, const ResultHeader&);
+
+        // Throws std::runtime_error if the file is not a result file
+        static ResultHeader readHeader(const std::string&);
+
+        // Writes records of consecutive games starting from the given one
+        void write(const int, const std::vector <GameRecord>&);
+
+        // The records of all the games, the ones never written are zeros
+        // Throws std::runtime_error if the file is not a result file of a batch with the given header,
+        // the message tells the first setting that differs
+        static std::vector <GameRecord> read(const std::string&, const ResultHeader&);
+
+    private:
+        static constexpr int m_headerSize = 80;
+        static constexpr int m_policyNameOffset = 56;
+        static constexpr int m_recordSize = 16;
+        static constexpr std::uint32_t m_version = 2;
+
+        std::FILE* m_file;
+        std::vector <unsigned char> m_buffer;
+
+        static ResultHeader readHeader(std::FILE*, const std::string&);
+
+        static void putInteger(unsigned char*, const std::uint64_t, const int);
+        static std::uint64_t getInteger(const unsigned char*, const int);
+};
+
+#endif // RESULTFILE_HPP
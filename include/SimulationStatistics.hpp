@@ -0,0 +1,44 @@
+#ifndef SIMULATIONSTATISTICS_HPP
+#define SIMULATIONSTATISTICS_HPP
+
+#include "Simulator.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+/*
+ * Collects results of simulated games to describe the distribution of scores
+ */
+class SimulationStatistics
+{
+    public:
+        SimulationStatistics();
+        virtual ~SimulationStatistics();
+
+        void add(const GameResult&);
+        void merge(const SimulationStatistics&);
+
+        int getGameCount() const;
+        std::int64_t getMoveCount() const;
+
+        int getMinScore() const;
+        int getMaxScore() const;
+        double getMeanScore() const;
+        double getScoreDeviation() const;
+
+        // The score that the given fraction of games does not exceed
+        int getScorePercentile(const double);
+
+        // Splits scores into the given number of buckets of equal width and counts games in each
+        // The width is returned through the second argument
+        std::vector <int> getScoreHistogram(const int, int&) const;
+
+    private:
+        std::vector <int> m_scores;
+        std::int64_t m_moveCount;
+        bool m_isSorted;
+};
+
+#endif // SIMULATIONSTATISTICS_HPP
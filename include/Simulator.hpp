@@ -0,0 +1,33 @@
+#ifndef SIMULATOR_HPP
+#define SIMULATOR_HPP
+
+#include "GameEngine.hpp"
+#include "MovePolicy.hpp"
+
+struct GameResult
+{
+    int score;
+    int moveCount;
+};
+
+/*
+ * Plays whole games without a player, the moves are chosen by a policy
+ * and made directly without the picks of the user interface
+ */
+class Simulator
+{
+    public:
+        Simulator(MovePolicy&);
+        virtual ~Simulator();
+
+        // A game ends when it is over, when no move is possible or after the given number of moves
+        GameResult playGame(GameEngine&, const int, const int, const int, const int);
+
+        // Plays the current game of the engine on, e.g. a loaded snapshot
+        GameResult continueGame(GameEngine&, const int);
+
+    private:
+        MovePolicy& m_policy;
+};
+
+#endif // SIMULATOR_HPP
@@ -0,0 +1,72 @@
+#ifndef SNAPSHOTFILE_HPP
+#define SNAPSHOTFILE_HPP
+
+#include "GameEngine.hpp"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+
+/*
+ * Keeps the snapshot of a game in a file that survives a crash at any moment
+ *
+ * A snapshot is written into a temporary file next to the file, flushed to the disk
+ * and renamed over the file, so the file always holds either the previous snapshot or the new one whole
+ *
+ * The background saves copy the snapshot and leave the writing to a thread of the file,
+ * so a frame never waits for the disk
+ */
+class SnapshotFile
+{
+    public:
+        SnapshotFile(const std::string&);
+
+        // Writes the snapshot of the last background save if it is still waiting
+        virtual ~SnapshotFile();
+
+        // Throws std::runtime_error if the file cannot be written
+        void save(const GameEngine&);
+
+        // Copies the snapshot for the writer thread and returns at once,
+        // a snapshot still waiting to be written is replaced by the new one
+        // Must not be mixed with save, returns false if a background write has failed since the last check
+        bool saveInBackground(const GameEngine&);
+
+        // Waits until the snapshots saved in background are written
+        // Returns false if a background write has failed since the last check
+        bool waitForBackgroundSaves();
+
+        // Returns false if there is no file
+        // Throws std::runtime_error if it is not a snapshot, the engine stays as it was then
+        bool load(GameEngine&);
+
+        // The bytes of the file, e.g. to load them into many engines, empty if there is no file
+        const std::vector <unsigned char>& read();
+
+    private:
+        std::string m_path;
+        std::string m_temporaryPath;
+        std::vector <unsigned char> m_buffer;
+
+        // The render thread fills the waiting snapshot, the writer swaps it with the written one,
+        // so both keep their capacity and the saves do not allocate
+        std::vector <unsigned char> m_waitingBuffer;
+        std::vector <unsigned char> m_writtenBuffer;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_isWaiting;
+        bool m_isWriting;
+        bool m_isRunning;
+        bool m_isWriteFailed;
+
+        // Started by the first background save
+        std::thread m_thread;
+
+        void run();
+        void writeTemporaryFile(const std::vector <unsigned char>&);
+};
+
+#endif // SNAPSHOTFILE_HPP
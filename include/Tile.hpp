@@ -1,14 +1,18 @@
 #ifndef TILE_HPP
 #define TILE_HPP
 
+#include <cstdint>
+
 /*
 All the tilemap has three types of balls:
 1. usual balls;
 2. those that appear on the next move (sort of a hint);
 3. those that the player selects
+
+Every tile fits in one byte, so the tilemap stays compact in memory
 */
 
-enum class Tile
+enum class Tile : std::uint8_t
 {
     Empty,
 
@@ -42,6 +46,9 @@ enum class Tile
     SelectedColorEight,
     SelectedColorEnd,
 
+    // Surrounds the tilemap, is never drawn and never passable
+    Border,
+
     Count
 };
 
@@ -96,4 +103,10 @@ inline bool isSelected(Tile x)
     return (x >= Tile::SelectedColorOne && x < Tile::SelectedColorEnd);
 }
 
+// A ball can move through free cells and through the balls of the next move
+inline bool isPassable(Tile x)
+{
+    return (x == Tile::Empty || isExpected(x));
+}
+
 #endif // TILE_HPP
@@ -0,0 +1,47 @@
+#ifndef TILEMAPVERTICES_HPP
+#define TILEMAPVERTICES_HPP
+
+#include "Tile.hpp"
+#include "GameEngine.hpp"
+
+#include <SFML/Graphics/VertexArray.hpp>
+#include <SFML/Graphics/Rect.hpp>
+
+#include <array>
+#include <unordered_map>
+
+/*
+ * The tilemap as arrays of textured quads, one array per chunk of tiles
+ *
+ * Only the chunks in sight are kept, and only the chunks changed since the last frame are built again
+ * Every array gets room for a cell and a ball on every tile of its chunk when the chunk comes into sight,
+ * so the frames over the same chunks allocate nothing, whatever the moves change
+ */
+class TileMapVertices
+{
+    public:
+        using TextureRects = std::array <sf::IntRect, static_cast <int>(Tile::Count)>;
+
+        // The rectangles of the tiles in the atlas must outlive the vertices
+        TileMapVertices(GameEngine&, const TextureRects&, const int);
+        virtual ~TileMapVertices();
+
+        // Drops the chunks out of the given rows and columns of chunks,
+        // builds the chunks coming into sight and the changed ones and clears the dirty region of the game
+        void update(const TileRectangle&);
+
+        // Only the chunks of the last update are kept
+        const sf::VertexArray& getChunk(const int) const;
+
+    private:
+        GameEngine& m_game;
+        const TextureRects& m_textureRects;
+        const int m_spriteSize;
+
+        std::unordered_map <int, sf::VertexArray> m_chunks;
+
+        void buildChunk(const TileRectangle&, sf::VertexArray&);
+        void appendTileQuad(sf::VertexArray&, const sf::Vector2f&, const Tile);
+};
+
+#endif // TILEMAPVERTICES_HPP
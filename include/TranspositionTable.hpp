@@ -0,0 +1,99 @@
+#ifndef TRANSPOSITIONTABLE_HPP
+#define TRANSPOSITIONTABLE_HPP
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+
+/*
+ * Keeps the values of searched positions by their hashes,
+ * so a position reached again by another order of moves is not searched again
+ *
+ * The table has a fixed power of two number of slots, one position per slot,
+ * and a slot is taken by a new position only if it is searched at least as deep as the old one
+ *
+ * Threads share the table without locks: a slot keeps the data and the key mixed with the data,
+ * so a slot written by two threads at once does not match either key and is just missed
+ */
+class TranspositionTable
+{
+    public:
+        struct Entry
+        {
+            float value;
+            int depth;
+        };
+
+        TranspositionTable();
+        virtual ~TranspositionTable();
+
+        // The count of slots is the greatest power of two fitting in the given count of bytes
+        void resize(const std::size_t);
+        void clear();
+
+        std::size_t getSlotCount() const;
+
+        // Returns false if the position is not in the table
+        bool probe(const std::uint64_t, Entry&) const;
+        void store(const std::uint64_t, const Entry&);
+
+    private:
+        struct Slot
+        {
+            std::atomic <std::uint64_t> check;
+            std::atomic <std::uint64_t> data;
+        };
+
+        std::unique_ptr <Slot[]> m_slots;
+        std::size_t m_mask;
+
+        static std::uint64_t pack(const Entry&);
+        static Entry unpack(const std::uint64_t);
+};
+
+/*
+ * Searches probe the table at every node, so the probing is kept here to be inlined
+ */
+
+inline bool TranspositionTable::probe(const std::uint64_t key, Entry& entry) const
+{
+    if (!m_slots)
+        return false;
+
+    const auto& slot = m_slots[key & m_mask];
+    const auto data = slot.data.load(std::memory_order_relaxed);
+    const auto check = slot.check.load(std::memory_order_relaxed);
+
+    // An empty slot has no data at all
+    if (data == 0 || (check ^ data) != key)
+        return false;
+
+    entry = unpack(data);
+    return true;
+}
+
+/*
+ * The value takes the lower half, the depth plus one takes the upper half,
+ * so the data of any entry is not zero
+ */
+inline std::uint64_t TranspositionTable::pack(const Entry& entry)
+{
+    std::uint32_t valueBits;
+    std::memcpy(&valueBits, &entry.value, sizeof(valueBits));
+
+    return (static_cast <std::uint64_t>(static_cast <std::uint32_t>(entry.depth + 1)) << 32) | valueBits;
+}
+
+inline TranspositionTable::Entry TranspositionTable::unpack(const std::uint64_t data)
+{
+    Entry entry;
+
+    const auto valueBits = static_cast <std::uint32_t>(data);
+    std::memcpy(&entry.value, &valueBits, sizeof(entry.value));
+    entry.depth = static_cast <int>(data >> 32) - 1;
+
+    return entry;
+}
+
+#endif // TRANSPOSITIONTABLE_HPP
@@ -3,11 +3,20 @@
 
 #include "ResourceManager.hpp"
 #include "GameEngine.hpp"
+#include "ExpectimaxMovePolicy.hpp"
+#include "FrameProfiler.hpp"
+#include "Logger.hpp"
+#include "SnapshotFile.hpp"
+#include "TileMapVertices.hpp"
 
 #include <SFML/Graphics.hpp>
 
-#include <sstream>
-#include <iomanip>
+#include <array>
+#include <vector>
+#include <string>
+#include <thread>
+#include <cstdio>
+#include <stdexcept>
 
 class UserInterface
 {
@@ -15,6 +24,16 @@ class UserInterface
         UserInterface(GameEngine&, const ResourceManager&);
         virtual ~UserInterface();
 
+        // Frames slow enough to be seen are logged, the logger must outlive the interface
+        void setLogger(Logger*);
+
+        // The game is saved into the file in background after every move, undo and redo and at the exit,
+        // the file must outlive the interface
+        void setAutosave(SnapshotFile*);
+
+        // F4 writes the times of the last frames into the file, frames.csv in the working directory by default
+        void setFrameTracePath(const std::string&);
+
         void startMainLoop();
         void renderGame();
 
@@ -30,18 +49,89 @@ class UserInterface
 
         sf::RectangleShape m_infoPanel;
         sf::Color m_textColor;
-        sf::Font m_font;
         sf::Text m_scoreText;
         sf::Text m_timeText;
         sf::RectangleShape m_gameOverPanel;
         sf::Text m_gameOverText;
 
+        // Texts are formatted here instead of a new string every time
+        std::array <char, 32> m_textBuffer;
+
+        // The tilemap is shown through a view below the info panel, which scrolls and zooms over it
+        // Only the chunks in sight are kept as vertices, so huge tilemaps cost no more than small ones
+        sf::View m_boardView;
+        float m_minViewWidth;
+        float m_maxViewWidth;
+        TileMapVertices m_tileMapVertices;
+
+        // The move suggested by the search is framed until the position changes,
+        // selecting a ball does not change the hash, so the frames stay
+        ExpectimaxMovePolicy m_hintPolicy;
+        Move m_hint;
+        std::uint64_t m_hintHash;
+        bool m_isHintAvailable;
+        sf::RectangleShape m_hintFrame;
+
+        // A move of the player is made only after the ball has rolled along its path,
+        // until then the tilemap keeps the ball selected at the source, and the rolling ball is drawn above it
+        // The path buffer is kept between the moves, so rolling allocates nothing
+        std::vector <std::pair <int, int>> m_movePath;
+        bool m_isBallMoving;
+        sf::Clock m_moveClock;
+        float m_moveDurationInSeconds;
+        sf::Sprite m_movingBall;
+        sf::Sprite m_vacatedCell;
+
+        // What the window shows now, so a frame is presented only when something differs
+        bool m_isRedrawNeeded;
+        int m_renderedScore;
+        int m_renderedTime;
+        bool m_isGameOverRendered;
+        const sf::Time m_idleFrameTime;
+
+        // Every frame is timed, the overlay shows the latest ones
+        // and the whole trace is written to a file on a separate thread
+        FrameProfiler m_profiler;
+        int m_drawCallCount;
+        bool m_isOverlayVisible;
+        sf::Clock m_overlayClock;
+        const sf::Time m_overlayRefreshTime;
+        sf::RectangleShape m_overlayPanel;
+        sf::Text m_overlayText;
+        std::string m_overlayString;
+        std::thread m_traceThread;
+        std::string m_traceFilePath;
+        Logger* m_logger;
+
+        SnapshotFile* m_autosave;
+        std::uint64_t m_savedPositionVersion;
+
         void processTimer();
         void processClick();
+        void pickTile(const int, const int);
+        void processBallMove();
+        void finishBallMove();
+        void processKeyPress(const sf::Event::KeyEvent&);
+        void scrollBoardView(const float, const float);
+        void zoomBoardView(const float);
+        void resetBoardView();
+        void findHint();
+        void writeFrameTrace();
+        void saveGame();
+
+        bool isRedrawNeeded() const;
+
+        // Every drawing goes through here, so the draw calls of a frame are counted
+        void draw(sf::RenderTarget&, const sf::Drawable&, const sf::RenderStates& = sf::RenderStates::Default);
 
         void renderInfoPanel();
         void renderTileMap();
+        TileRectangle getVisibleChunks() const;
+        void renderMovingBall();
+        void renderHint();
         void renderGameOverPanel();
+        void renderOverlay();
+        void updateOverlayText();
 };
 
 #endif // USERINTERFACE_HPP
@@ -2,26 +2,122 @@
 #include "GameEngine.hpp"
 #include "UserInterface.hpp"
 #include "Logger.hpp"
+#include "ReplayRecorder.hpp"
+#include "SnapshotFile.hpp"
 
-int main()
+#include <iostream>
+#include <memory>
+#include <string>
+#include <cstdlib>
+#include <filesystem>
+#include <system_error>
+
+/*
+ * The files the game writes go into a directory of the user, so the game can be started from anywhere:
+ * %APPDATA%/ColorLines on Windows, ~/Library/Application Support/ColorLines on macOS
+ * and $XDG_DATA_HOME/colorlines or ~/.local/share/colorlines elsewhere
+ * Without a home or if the directory cannot be created, the working directory is used as before
+ */
+std::filesystem::path getDataDirectory()
+{
+    std::filesystem::path directory;
+
+#if defined(_WIN32)
+    if (const auto appData = std::getenv("APPDATA"))
+        directory = std::filesystem::path(appData) / "ColorLines";
+#elif defined(__APPLE__)
+    if (const auto home = std::getenv("HOME"))
+        directory = std::filesystem::path(home) / "Library" / "Application Support" / "ColorLines";
+#else
+    const auto dataHome = std::getenv("XDG_DATA_HOME");
+    const auto home = std::getenv("HOME");
+
+    if (dataHome != nullptr && *dataHome != '\0')
+        directory = std::filesystem::path(dataHome) / "colorlines";
+    else if (home != nullptr)
+        directory = std::filesystem::path(home) / ".local" / "share" / "colorlines";
+#endif
+
+    std::error_code error;
+
+    if (directory.empty() || (!std::filesystem::create_directories(directory, error) && error))
+        return std::filesystem::current_path(error);
+
+    return directory;
+}
+
+/*
+ * The board is 9x9 with 8 colors unless its width, height and number of colors are given,
+ * e.g. huge boards are played to load the engine and the rendering
+ * Without them, the game left by the previous run is continued
+ */
+int main(int argc, char* argv[])
 {
-    Logger logger;
+    const auto dataDirectory = getDataDirectory();
+
+    // Declared first, so it outlives everything that logs
+    std::unique_ptr <Logger> logger;
     ResourceManager resourceManager;
+    SnapshotFile autosave((dataDirectory / "autosave.cls").string());
+
+    // Declared before the engine, so the engine ends the last game on it before it is closed
+    std::unique_ptr <ReplayRecorder> replayRecorder;
     GameEngine game;
 
     try
     {
-        resourceManager.loadSprites();
-        resourceManager.loadFont();
+        // The events of the previous run are kept in events.log.1
+        // A log that cannot be created only loses the events, the game is played without them
+        try
+        {
+            logger = std::make_unique <Logger>((dataDirectory / "events.log").string(), LogLevel::Debug, 16 << 20, 3);
+        }
+        catch (const std::runtime_error& e)
+        {
+            std::cerr << "Warning: " << e.what() << ", the events are not logged\n";
+        }
+
+        resourceManager.load();
+
+        // Every game is recorded, so a bug can be reproduced from its replay
+        replayRecorder = std::make_unique <ReplayRecorder>((dataDirectory / "replays.clr").string());
+        game.setReplayRecorder(replayRecorder.get());
+        game.setLogger(logger.get());
+
+        const auto widthInTiles = (argc > 2) ? std::stoi(argv[1]) : 9;
+        const auto heightInTiles = (argc > 2) ? std::stoi(argv[2]) : 9;
+        const auto colorCount = (argc > 3) ? std::stoi(argv[3]) : 8;
+
+        auto isResumed = false;
+
+        // A damaged autosave is only a reason to start a new game
+        if (argc <= 2)
+        {
+            try
+            {
+                isResumed = autosave.load(game);
+            }
+            catch (const std::runtime_error&)
+            {
+            }
+        }
 
-        game.startNewGame(9, 9, 8);
+        if (!isResumed)
+            game.startNewGame(widthInTiles, heightInTiles, colorCount);
 
         UserInterface ui(game, resourceManager);
+        ui.setLogger(logger.get());
+        ui.setAutosave(&autosave);
+        ui.setFrameTracePath((dataDirectory / "frames.csv").string());
         ui.startMainLoop();
     }
+    // Without a logger there is nowhere to write the board either
     catch (const std::exception& e)
     {
-        logger.writeError(game, e);
+        if (logger != nullptr)
+            logger->writeError(game, e);
+        else
+            std::cerr << "Error: " << e.what() << '\n';
     }
 
     return 0;
@@ -0,0 +1,251 @@
+#include "AssetBundle.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+    // "CLAB" read as a little-endian number
+    constexpr std::uint64_t bundleSignature = 0x42414C43;
+
+    // Slots are separated by transparent padding,
+    // so smoothing never picks pixels of neighbour slots
+    const int atlasColumnCount = 8;
+    const int atlasPaddingInPixels = 1;
+
+    const int channelCount = 4;
+}
+
+AssetBundle::AssetBundle(const unsigned char* data, const std::size_t size) :
+    m_data(data),
+    m_spriteSize(0),
+    m_atlasWidth(0),
+    m_atlasHeight(0),
+    m_fontSize(0)
+{
+    if (size < m_headerSize || getInteger(data, 4) != bundleSignature || getInteger(data + 4, 4) != m_version)
+        throw std::runtime_error("Not an asset bundle");
+
+    m_spriteSize = static_cast <int>(getInteger(data + 8, 4));
+    m_atlasWidth = static_cast <int>(getInteger(data + 12, 4));
+    m_atlasHeight = static_cast <int>(getInteger(data + 16, 4));
+    m_fontSize = static_cast <std::size_t>(getInteger(data + 24, 8));
+
+    const auto tileCount = getInteger(data + 20, 4);
+    const auto pixelSize = static_cast <std::size_t>(m_atlasWidth) * m_atlasHeight * channelCount;
+
+    if (tileCount != static_cast <std::uint64_t>(Tile::Count) ||
+        size != m_headerSize + tileCount * m_rectSize + pixelSize + m_fontSize)
+    {
+        throw std::runtime_error("Damaged asset bundle");
+    }
+}
+
+AssetBundle::~AssetBundle()
+{
+    //dtor
+}
+
+/*
+ * Every kind of tile has its own slot in the atlas, the slot of an empty tile holds the cell
+ */
+std::vector <unsigned char> AssetBundle::pack(const AssetImage& cell,
+                                              const std::vector <AssetImage>& balls,
+                                              const std::vector <unsigned char>& font,
+                                              const int spriteSize)
+{
+    const auto tileCount = static_cast <int>(Tile::Count);
+    if (static_cast <int>(balls.size()) != static_cast <int>(Tile::ColorEnd) - static_cast <int>(Tile::ColorOne))
+        throw std::runtime_error("Every color needs its ball");
+
+    const auto slotSize = spriteSize + 2 * atlasPaddingInPixels;
+    const auto rowCount = (tileCount + atlasColumnCount - 1) / atlasColumnCount;
+    const auto atlasWidth = slotSize * atlasColumnCount;
+    const auto atlasHeight = slotSize * rowCount;
+
+    std::vector <unsigned char> atlas(static_cast <std::size_t>(atlasWidth) * atlasHeight * channelCount, 0);
+    std::vector <AtlasRect> rects(tileCount, AtlasRect {0, 0, 0, 0});
+
+    const auto draw = [&](const Tile tile, const AssetImage& image, const float scale)
+    {
+        const auto slot = static_cast <int>(tile);
+
+        auto& rect = rects[slot];
+        rect.left = (slot % atlasColumnCount) * slotSize + atlasPaddingInPixels;
+        rect.top = (slot / atlasColumnCount) * slotSize + atlasPaddingInPixels;
+        rect.width = spriteSize;
+        rect.height = spriteSize;
+
+        drawSprite(atlas, atlasWidth, rect, image, scale);
+    };
+
+    draw(Tile::Empty, cell, 1.0f);
+
+    for (auto tile = Tile::ColorOne; tile < Tile::ColorEnd; tile++)
+    {
+        const auto& ball = balls[static_cast <int>(tile - Tile::ColorOne)];
+
+        draw(tile, ball, 1.0f);
+        draw(normalToExpected(tile), ball, 0.5f);
+        draw(normalToSelected(tile), ball, 1.5f);
+    }
+
+    std::vector <unsigned char> bundle(m_headerSize + tileCount * m_rectSize + atlas.size() + font.size());
+    auto data = bundle.data();
+
+    putInteger(data, bundleSignature, 4);
+    putInteger(data + 4, m_version, 4);
+    putInteger(data + 8, spriteSize, 4);
+    putInteger(data + 12, atlasWidth, 4);
+    putInteger(data + 16, atlasHeight, 4);
+    putInteger(data + 20, tileCount, 4);
+    putInteger(data + 24, font.size(), 8);
+    data += m_headerSize;
+
+    for (const auto& rect : rects)
+    {
+        putInteger(data, rect.left, 2);
+        putInteger(data + 2, rect.top, 2);
+        putInteger(data + 4, rect.width, 2);
+        putInteger(data + 6, rect.height, 2);
+        data += m_rectSize;
+    }
+
+    data = std::copy(atlas.begin(), atlas.end(), data);
+    std::copy(font.begin(), font.end(), data);
+
+    return bundle;
+}
+
+/*
+ * The sprite is drawn the way a smoothed texture is drawn onto a transparent one:
+ * every pixel is sampled bilinearly at its center, the edges of the image are stretched beyond it,
+ * and blending leaves the colors multiplied by the alpha
+ *
+ * A scale other than one changes the rectangle of the image that fills the sprite, not the sprite itself:
+ * the rectangle is centered on the image, and the math is the same as it was with the textures
+ */
+void AssetBundle::drawSprite(std::vector <unsigned char>& atlas,
+                             const int atlasWidth,
+                             const AtlasRect& rect,
+                             const AssetImage& image,
+                             const float scale)
+{
+    const auto factor = 1 / scale;
+
+    const auto sourceLeft = static_cast <int>(image.width * (1.0f - factor) / 2);
+    const auto sourceTop = static_cast <int>(image.height * (1.0f - factor) / 2);
+    const auto sourceWidth = static_cast <int>(image.width * factor);
+    const auto sourceHeight = static_cast <int>(image.height * factor);
+
+    float color[channelCount];
+
+    for (auto y = 0; y < rect.height; y++)
+    {
+        auto pixel = atlas.data() + (static_cast <std::size_t>(rect.top + y) * atlasWidth + rect.left) * channelCount;
+
+        for (auto x = 0; x < rect.width; x++, pixel += channelCount)
+        {
+            sampleImage(image,
+                        sourceLeft + (x + 0.5f) * sourceWidth / rect.width,
+                        sourceTop + (y + 0.5f) * sourceHeight / rect.height,
+                        color);
+
+            const auto alpha = color[3] / 255;
+
+            for (auto channel = 0; channel < 3; channel++)
+                pixel[channel] = static_cast <unsigned char>(color[channel] * alpha + 0.5f);
+
+            pixel[3] = static_cast <unsigned char>(color[3] + 0.5f);
+        }
+    }
+}
+
+/*
+ * Pixel centers lie at half-integer coordinates, the nearest pixels are clamped to the image
+ */
+void AssetBundle::sampleImage(const AssetImage& image, const float x, const float y, float (&color)[4])
+{
+    const auto left = std::floor(x - 0.5f);
+    const auto top = std::floor(y - 0.5f);
+    const auto horizontalWeight = x - 0.5f - left;
+    const auto verticalWeight = y - 0.5f - top;
+
+    const auto clampColumn = [&image](const int column) { return std::clamp(column, 0, image.width - 1); };
+    const auto clampRow = [&image](const int row) { return std::clamp(row, 0, image.height - 1); };
+
+    const int columns[] {clampColumn(static_cast <int>(left)), clampColumn(static_cast <int>(left) + 1)};
+    const int rows[] {clampRow(static_cast <int>(top)), clampRow(static_cast <int>(top) + 1)};
+    const float horizontalWeights[] {1 - horizontalWeight, horizontalWeight};
+    const float verticalWeights[] {1 - verticalWeight, verticalWeight};
+
+    std::fill(std::begin(color), std::end(color), 0.0f);
+
+    for (auto i = 0; i < 2; i++)
+    {
+        for (auto j = 0; j < 2; j++)
+        {
+            const auto weight = verticalWeights[i] * horizontalWeights[j];
+            const auto pixel = image.pixels.data() + (static_cast <std::size_t>(rows[i]) * image.width + columns[j]) * channelCount;
+
+            for (auto channel = 0; channel < channelCount; channel++)
+                color[channel] += weight * pixel[channel];
+        }
+    }
+}
+
+int AssetBundle::getSpriteSize() const
+{
+    return m_spriteSize;
+}
+
+int AssetBundle::getAtlasWidth() const
+{
+    return m_atlasWidth;
+}
+
+int AssetBundle::getAtlasHeight() const
+{
+    return m_atlasHeight;
+}
+
+const unsigned char* AssetBundle::getAtlasPixels() const
+{
+    return m_data + m_headerSize + static_cast <int>(Tile::Count) * m_rectSize;
+}
+
+AtlasRect AssetBundle::getTextureRect(const Tile tile) const
+{
+    const auto rect = m_data + m_headerSize + static_cast <int>(tile) * m_rectSize;
+
+    return AtlasRect {static_cast <int>(getInteger(rect, 2)),
+                      static_cast <int>(getInteger(rect + 2, 2)),
+                      static_cast <int>(getInteger(rect + 4, 2)),
+                      static_cast <int>(getInteger(rect + 6, 2))};
+}
+
+const unsigned char* AssetBundle::getFontData() const
+{
+    return getAtlasPixels() + static_cast <std::size_t>(m_atlasWidth) * m_atlasHeight * channelCount;
+}
+
+std::size_t AssetBundle::getFontSize() const
+{
+    return m_fontSize;
+}
+
+void AssetBundle::putInteger(unsigned char* data, const std::uint64_t value, const int byteCount)
+{
+    for (auto i = 0; i < byteCount; i++)
+        data[i] = static_cast <unsigned char>(value >> (8 * i));
+}
+
+std::uint64_t AssetBundle::getInteger(const unsigned char* data, const int byteCount)
+{
+    std::uint64_t value = 0;
+
+    for (auto i = 0; i < byteCount; i++)
+        value |= static_cast <std::uint64_t>(data[i]) << (8 * i);
+
+    return value;
+}
@@ -0,0 +1,261 @@
+#include "BatchRunner.hpp"
+
+BatchRunner::BatchRunner(const BatchSettings& settings, const PolicyFactory& makePolicy) :
+    m_settings(settings),
+    m_makePolicy(makePolicy),
+    m_ranges(settings.threadCount),
+    m_logger(nullptr)
+{
+    //ctor
+}
+
+BatchRunner::~BatchRunner()
+{
+    //dtor
+}
+
+void BatchRunner::setLogger(Logger* logger)
+{
+    m_logger = logger;
+}
+
+SimulationStatistics BatchRunner::run(const std::string& resultPath, const std::string& replayPath)
+{
+    const auto threadCount = m_settings.threadCount;
+    const auto chunkCount = (m_settings.gameCount + m_settings.gamesPerChunk - 1) / m_settings.gamesPerChunk;
+
+    for (auto i = 0; i < threadCount; i++)
+    {
+        const auto begin = static_cast <std::int64_t>(chunkCount) * i / threadCount;
+        const auto end = static_cast <std::int64_t>(chunkCount) * (i + 1) / threadCount;
+        m_ranges[i].range.store(packRange(begin, end));
+    }
+
+    m_writtenRecords.clear();
+
+    if (!resultPath.empty())
+    {
+        if (m_settings.isResumed)
+            m_writtenRecords = ResultFile::read(resultPath, makeResultHeader());
+        else
+            ResultFile::create(resultPath, makeResultHeader());
+    }
+
+    std::vector <SimulationStatistics> statistics(threadCount);
+    std::vector <std::exception_ptr> errors(threadCount);
+    std::vector <std::thread> threads;
+
+    for (auto i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back([this, i, &statistics, &errors, &resultPath, &replayPath]()
+        {
+            try
+            {
+                work(i, statistics[i], resultPath, replayPath);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (const auto& error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    SimulationStatistics total;
+    for (const auto& part : statistics)
+        total.merge(part);
+
+    return total;
+}
+
+/*
+ * A chunk is written whole, and a written record has the seed of its game, which zeros of a gap never have
+ */
+bool BatchRunner::isChunkWritten(const int firstGame, const int lastGame) const
+{
+    if (m_writtenRecords.empty())
+        return false;
+
+    for (auto i = firstGame; i < lastGame; i++)
+    {
+        if (m_writtenRecords[i].seed != RandomNumberGenerator::mixSeed(m_settings.masterSeed, i))
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * The start position is hashed with FNV-1a, as the header has no room for the snapshot itself
+ */
+ResultHeader BatchRunner::makeResultHeader() const
+{
+    std::uint64_t startPositionHash = 0;
+
+    if (!m_settings.startPosition.empty())
+    {
+        startPositionHash = 14695981039346656037ULL;
+
+        for (const auto byte : m_settings.startPosition)
+            startPositionHash = (startPositionHash ^ byte) * 1099511628211ULL;
+    }
+
+    return ResultHeader {m_settings.gameCount,
+                         m_settings.masterSeed,
+                         m_settings.widthInTiles,
+                         m_settings.heightInTiles,
+                         m_settings.colorCount,
+                         m_settings.maxMoveCount,
+                         static_cast <std::int32_t>(m_settings.randomAlgorithm),
+                         startPositionHash,
+                         m_settings.policyName};
+}
+
+std::uint64_t BatchRunner::packRange(const std::uint32_t begin, const std::uint32_t end)
+{
+    return (static_cast <std::uint64_t>(begin) << 32) | end;
+}
+
+/*
+ * The owner takes the first chunk of its share
+ */
+bool BatchRunner::takeChunk(const int thread, int& chunk)
+{
+    auto& range = m_ranges[thread].range;
+    auto current = range.load();
+
+    while (true)
+    {
+        const auto begin = static_cast <std::uint32_t>(current >> 32);
+        const auto end = static_cast <std::uint32_t>(current);
+
+        if (begin >= end)
+            return false;
+
+        // On failure 'current' is reloaded, so a thief might have taken the chunk meanwhile
+        if (range.compare_exchange_weak(current, packRange(begin + 1, end)))
+        {
+            chunk = begin;
+            return true;
+        }
+    }
+}
+
+/*
+ * Takes the back half of the first non-empty share of other threads
+ * The stolen chunks become the share of the thief, which is empty at the moment,
+ * and no thief touches an empty share
+ */
+bool BatchRunner::stealChunks(const int thread)
+{
+    const auto threadCount = static_cast <int>(m_ranges.size());
+
+    for (auto i = 1; i < threadCount; i++)
+    {
+        auto& range = m_ranges[(thread + i) % threadCount].range;
+        auto current = range.load();
+
+        while (true)
+        {
+            const auto begin = static_cast <std::uint32_t>(current >> 32);
+            const auto end = static_cast <std::uint32_t>(current);
+
+            if (begin >= end)
+                break;
+
+            const auto middle = end - (end - begin + 1) / 2;
+
+            if (range.compare_exchange_weak(current, packRange(begin, middle)))
+            {
+                m_ranges[thread].range.store(packRange(middle, end));
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void BatchRunner::work(const int thread,
+                       SimulationStatistics& statistics,
+                       const std::string& resultPath,
+                       const std::string& replayPath)
+{
+    // The recorder outlives the engine, which ends the last game on it
+    std::unique_ptr <ReplayRecorder> replayRecorder;
+    if (!replayPath.empty())
+        replayRecorder = std::make_unique <ReplayRecorder>(replayPath);
+
+    GameEngine game;
+    game.setRandomAlgorithm(m_settings.randomAlgorithm);
+    game.setReplayRecorder(replayRecorder.get());
+    game.setLogger(m_logger);
+
+    auto policy = m_makePolicy();
+    Simulator simulator(*policy);
+
+    std::unique_ptr <ResultFile> resultFile;
+    if (!resultPath.empty())
+        resultFile = std::make_unique <ResultFile>(resultPath);
+
+    std::vector <GameRecord> records;
+    records.reserve(m_settings.gamesPerChunk);
+
+    auto chunk = 0;
+
+    while (takeChunk(thread, chunk) || (stealChunks(thread) && takeChunk(thread, chunk)))
+    {
+        const auto firstGame = chunk * m_settings.gamesPerChunk;
+        const auto lastGame = std::min(firstGame + m_settings.gamesPerChunk, m_settings.gameCount);
+
+        if (isChunkWritten(firstGame, lastGame))
+        {
+            for (auto i = firstGame; i < lastGame; i++)
+                statistics.add(GameResult {m_writtenRecords[i].score, m_writtenRecords[i].moveCount});
+
+            continue;
+        }
+
+        records.clear();
+
+        for (auto i = firstGame; i < lastGame; i++)
+        {
+            // The engine and the policy get different streams of the same game seed
+            const auto seed = RandomNumberGenerator::mixSeed(m_settings.masterSeed, i);
+            game.setRandomSeed(seed);
+            policy->setSeed(RandomNumberGenerator::mixSeed(seed, 0));
+
+            GameResult result;
+
+            if (m_settings.startPosition.empty())
+            {
+                result = simulator.playGame(game,
+                                            m_settings.widthInTiles,
+                                            m_settings.heightInTiles,
+                                            m_settings.colorCount,
+                                            m_settings.maxMoveCount);
+            }
+            else
+            {
+                // Loading takes the generator of the snapshot, so the seed of the game replaces it
+                game.load(m_settings.startPosition);
+                game.setRandomSeed(seed);
+                result = simulator.continueGame(game, m_settings.maxMoveCount);
+            }
+
+            statistics.add(result);
+            records.push_back(GameRecord {seed, result.score, result.moveCount});
+        }
+
+        if (resultFile)
+            resultFile->write(firstGame, records);
+    }
+}
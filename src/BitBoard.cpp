@@ -0,0 +1,137 @@
+#include "BitBoard.hpp"
+
+BitBoard::BitBoard()
+{
+    //ctor
+}
+
+BitBoard::~BitBoard()
+{
+    //dtor
+}
+
+void BitBoard::resize(const int bitCount)
+{
+    m_words.assign((bitCount + m_bitsPerWord - 1) / m_bitsPerWord, 0);
+}
+
+void BitBoard::clear()
+{
+    std::fill(m_words.begin(), m_words.end(), 0);
+}
+
+bool BitBoard::any() const
+{
+    for (const auto word : m_words)
+    {
+        if (word != 0)
+            return true;
+    }
+
+    return false;
+}
+
+int BitBoard::count() const
+{
+    auto bitCount = 0;
+
+    for (const auto word : m_words)
+        bitCount += std::popcount(word);
+
+    return bitCount;
+}
+
+bool BitBoard::intersects(const BitBoard& other) const
+{
+    for (size_t i = 0; i < m_words.size(); i++)
+    {
+        if ((m_words[i] & other.m_words[i]) != 0)
+            return true;
+    }
+
+    return false;
+}
+
+int BitBoard::findNext(const int bit) const
+{
+    auto i = bit / m_bitsPerWord;
+    if (i >= static_cast <int>(m_words.size()))
+        return -1;
+
+    // The bits below the starting one are masked out in the first word only
+    auto word = m_words[i] & (~std::uint64_t(0) << (bit % m_bitsPerWord));
+
+    while (word == 0)
+    {
+        if (++i == static_cast <int>(m_words.size()))
+            return -1;
+
+        word = m_words[i];
+    }
+
+    return i * m_bitsPerWord + std::countr_zero(word);
+}
+
+void BitBoard::assign(const BitBoard& other)
+{
+    std::copy(other.m_words.begin(), other.m_words.end(), m_words.begin());
+}
+
+/*
+ * The shifted assignments go in the direction opposite to the shift,
+ * so a bitboard may be shifted in place
+ */
+
+void BitBoard::assignShiftedUp(const BitBoard& other, const int n)
+{
+    for (auto i = static_cast <int>(m_words.size()) - 1; i >= 0; i--)
+        m_words[i] = other.getWordShiftedUp(i, n);
+}
+
+void BitBoard::assignShiftedDown(const BitBoard& other, const int n)
+{
+    for (auto i = 0; i < static_cast <int>(m_words.size()); i++)
+        m_words[i] = other.getWordShiftedDown(i, n);
+}
+
+void BitBoard::andWith(const BitBoard& other)
+{
+    for (size_t i = 0; i < m_words.size(); i++)
+        m_words[i] &= other.m_words[i];
+}
+
+void BitBoard::orWith(const BitBoard& other)
+{
+    for (size_t i = 0; i < m_words.size(); i++)
+        m_words[i] |= other.m_words[i];
+}
+
+void BitBoard::andNotWith(const BitBoard& other)
+{
+    for (size_t i = 0; i < m_words.size(); i++)
+        m_words[i] &= ~other.m_words[i];
+}
+
+void BitBoard::andWithShiftedUp(const BitBoard& other, const int n)
+{
+    for (auto i = static_cast <int>(m_words.size()) - 1; i >= 0; i--)
+        m_words[i] &= other.getWordShiftedUp(i, n);
+}
+
+void BitBoard::andWithShiftedDown(const BitBoard& other, const int n)
+{
+    for (auto i = 0; i < static_cast <int>(m_words.size()); i++)
+        m_words[i] &= other.getWordShiftedDown(i, n);
+}
+
+void BitBoard::orWithShiftedUp(const BitBoard& other, const int n)
+{
+    for (auto i = static_cast <int>(m_words.size()) - 1; i >= 0; i--)
+        m_words[i] |= other.getWordShiftedUp(i, n);
+}
+
+void BitBoard::orWithShiftedDown(const BitBoard& other, const int n)
+{
+    for (auto i = 0; i < static_cast <int>(m_words.size()); i++)
+        m_words[i] |= other.getWordShiftedDown(i, n);
+}
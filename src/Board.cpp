@@ -0,0 +1,34 @@
+#include "Board.hpp"
+
+Board::Board() : m_width(0), m_height(0), m_stride(2)
+{
+    //ctor
+}
+
+Board::~Board()
+{
+    //dtor
+}
+
+/*
+ * Leaves all the cells empty
+ * The buffer keeps its capacity, so restarting a game of the same size does not allocate
+ */
+void Board::resize(const int widthInTiles, const int heightInTiles)
+{
+    m_width = widthInTiles;
+    m_height = heightInTiles;
+    m_stride = widthInTiles + 2;
+
+    m_tiles.assign(m_stride * (heightInTiles + 2), Tile::Border);
+    clear();
+}
+
+void Board::clear()
+{
+    for (auto row = 0; row < m_height; row++)
+    {
+        auto first = m_tiles.begin() + toIndex(row, 0);
+        std::fill(first, first + m_width, Tile::Empty);
+    }
+}
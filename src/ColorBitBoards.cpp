@@ -0,0 +1,112 @@
+#include "ColorBitBoards.hpp"
+
+ColorBitBoards::ColorBitBoards() : m_steps{0, 0, 0, 0}, m_minStreakLength(0)
+{
+    //ctor
+}
+
+ColorBitBoards::~ColorBitBoards()
+{
+    //dtor
+}
+
+/*
+ * Leaves all the bitboards empty, the board is used only for its size
+ */
+void ColorBitBoards::resize(const Board& board, const int colorCount, const int minStreakLength)
+{
+    const auto stride = board.getStride();
+
+    // Horizontal, vertical, main diagonal and anti-diagonal steps
+    m_steps[0] = 1;
+    m_steps[1] = stride;
+    m_steps[2] = stride + 1;
+    m_steps[3] = stride - 1;
+
+    m_minStreakLength = minStreakLength;
+
+    m_balls.resize(colorCount);
+    for (auto& balls : m_balls)
+        balls.resize(board.getCellCount());
+
+    m_runs.resize(board.getCellCount());
+    m_lines.resize(board.getCellCount());
+    m_streaks.resize(board.getCellCount());
+}
+
+void ColorBitBoards::update(const int index, const Tile oldTile, const Tile newTile)
+{
+    if (isBall(oldTile))
+        m_balls[static_cast <int>(oldTile - Tile::ColorOne)].reset(index);
+
+    if (isBall(newTile))
+        m_balls[static_cast <int>(newTile - Tile::ColorOne)].set(index);
+}
+
+/*
+ * Puts all the balls that are a part of a line along the step into m_lines
+ */
+void ColorBitBoards::findLinesAlong(const BitBoard& balls, const int step)
+{
+    // A bit stays in m_runs if a whole line starts at it
+    m_runs.assign(balls);
+    for (auto i = 1; i < m_minStreakLength; i++)
+        m_runs.andWithShiftedDown(balls, i * step);
+
+    // Then every start is spread over the length of the line
+    m_lines.assign(m_runs);
+    for (auto i = 1; i < m_minStreakLength; i++)
+        m_lines.orWithShiftedUp(m_runs, i * step);
+}
+
+/*
+ * A line found along a step contains the ball only if the whole streak of the ball is long enough,
+ * so the streak itself is then collected bit by bit in both directions
+ */
+const BitBoard& ColorBitBoards::findStreaksThrough(const int index, const Tile tile)
+{
+    const auto& balls = m_balls[static_cast <int>(tile - Tile::ColorOne)];
+
+    m_streaks.clear();
+    m_streaks.set(index);
+
+    for (const auto step : m_steps)
+    {
+        findLinesAlong(balls, step);
+        if (!m_lines.test(index))
+            continue;
+
+        for (auto i = index - step; balls.test(i); i -= step)
+            m_streaks.set(i);
+
+        for (auto i = index + step; balls.test(i); i += step)
+            m_streaks.set(i);
+    }
+
+    return m_streaks;
+}
+
+const BitBoard& ColorBitBoards::findLines(const Tile tile)
+{
+    const auto& balls = m_balls[static_cast <int>(tile - Tile::ColorOne)];
+
+    m_streaks.clear();
+
+    for (const auto step : m_steps)
+    {
+        findLinesAlong(balls, step);
+        m_streaks.orWith(m_lines);
+    }
+
+    return m_streaks;
+}
+
+int ColorBitBoards::countLineBalls()
+{
+    auto ballCount = 0;
+
+    for (auto tile = Tile::ColorOne; tile < Tile::ColorOne + static_cast <Tile>(m_balls.size()); tile++)
+        ballCount += findLines(tile).count();
+
+    return ballCount;
+}
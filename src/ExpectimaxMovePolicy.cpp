@@ -0,0 +1,370 @@
+#include "ExpectimaxMovePolicy.hpp"
+
+namespace
+{
+    // A lost game ends the scoring, so it is worse than anything a position can promise
+    const float gameOverValue = -1000.0f;
+
+    // The weights of a position, in points of the score
+    const float freeCellWeight = 0.1f;
+    const float sameNeighbourWeight = 0.25f;
+
+    const int movesBetweenTimeChecks = 64;
+}
+
+ExpectimaxMovePolicy::ExpectimaxMovePolicy() :
+    m_seed(0),
+    m_timeBudget(0),
+    m_maxDepth(2),
+    m_sampleCount(3),
+    m_rootWidth(12),
+    m_beamWidth(6),
+    m_nodeCount(0),
+    m_isAborted(false)
+{
+    m_table.resize(16 << 20);
+}
+
+ExpectimaxMovePolicy::~ExpectimaxMovePolicy()
+{
+    //dtor
+}
+
+void ExpectimaxMovePolicy::setSeed(const std::uint64_t seed)
+{
+    // The values in the table were averaged over the samples of another seed,
+    // they are not found again since the seed is mixed into the keys
+    m_seed = seed;
+}
+
+void ExpectimaxMovePolicy::setTimeBudget(const std::chrono::milliseconds timeBudget)
+{
+    m_timeBudget = timeBudget;
+}
+
+void ExpectimaxMovePolicy::setMaxDepth(const int maxDepth)
+{
+    m_maxDepth = std::max(1, maxDepth);
+}
+
+void ExpectimaxMovePolicy::setSampleCount(const int sampleCount)
+{
+    m_sampleCount = std::max(1, sampleCount);
+    m_table.clear();
+}
+
+void ExpectimaxMovePolicy::setRootWidth(const int rootWidth)
+{
+    m_rootWidth = std::max(1, rootWidth);
+}
+
+void ExpectimaxMovePolicy::setBeamWidth(const int beamWidth)
+{
+    m_beamWidth = std::max(1, beamWidth);
+    m_table.clear();
+}
+
+bool ExpectimaxMovePolicy::chooseMove(const GameEngine& game, Move& move)
+{
+    SearchResult result;
+
+    if (!search(game, result))
+        return false;
+
+    move = result.bestMove;
+    return true;
+}
+
+/*
+ * Every iteration searches one move deeper than the previous one
+ * An iteration stopped by the time is thrown away, except the first one,
+ * whose moves are all better than no move at all
+ */
+bool ExpectimaxMovePolicy::search(const GameEngine& game, SearchResult& result)
+{
+    // The engine is kept between the searches, and only the position is copied into it, not the history of the game
+    if (!m_game)
+        m_game.emplace();
+
+    m_game->copyPosition(game);
+
+    // The samples need a fast generator whatever the game uses
+    m_game->setRandomAlgorithm(RandomNumberGenerator::Algorithm::Xoshiro256StarStar);
+
+    m_nodeCount = 0;
+    m_isAborted = false;
+    m_deadline = std::chrono::steady_clock::now() + m_timeBudget;
+
+    prepareBuffers(m_maxDepth + 1);
+
+    auto& rootMoves = m_moves[0];
+    m_game->generateMoves(rootMoves);
+
+    if (rootMoves.empty())
+        return false;
+
+    // The values of the root moves, the best ones of an iteration are searched by the next one first
+    auto& rootRatings = m_ratings[0];
+    rootRatings.clear();
+
+    for (auto i = 0; i < static_cast <int>(rootMoves.size()); i++)
+        rootRatings.emplace_back(rateMove(m_game->getTileMap(), rootMoves[i]), i);
+
+    std::stable_sort(rootRatings.begin(), rootRatings.end(),
+                     [](const auto& first, const auto& second) { return first.first > second.first; });
+
+    result.bestMove = rootMoves[rootRatings[0].second];
+    result.principalVariation.assign(1, result.bestMove);
+    result.value = 0.0f;
+    result.depth = 0;
+
+    std::vector <std::pair <float, int>> values;
+
+    for (auto depth = 1; depth <= m_maxDepth; depth++)
+    {
+        const auto width = (depth == 1) ? static_cast <int>(rootRatings.size())
+                                        : std::min(m_rootWidth, static_cast <int>(rootRatings.size()));
+
+        values.clear();
+        auto bestValue = gameOverValue * 2;
+
+        for (auto i = 0; i < width; i++)
+        {
+            const auto& move = rootMoves[rootRatings[i].second];
+            const auto value = searchMove(move, depth, 0);
+
+            if (m_isAborted)
+                break;
+
+            values.emplace_back(value, rootRatings[i].second);
+
+            if (value > bestValue)
+            {
+                bestValue = value;
+
+                m_lines[0].assign(1, move);
+                m_lines[0].insert(m_lines[0].end(), m_sampleLines[0].begin(), m_sampleLines[0].end());
+            }
+        }
+
+        if (m_isAborted && (depth > 1 || values.empty()))
+            break;
+
+        result.bestMove = m_lines[0].front();
+        result.principalVariation = m_lines[0];
+        result.value = bestValue;
+        result.depth = depth;
+
+        if (m_isAborted)
+            break;
+
+        // The searched moves go first by their new values, the rest keep their order
+        std::stable_sort(values.begin(), values.end(),
+                         [](const auto& first, const auto& second) { return first.first > second.first; });
+
+        for (auto i = 0; i < static_cast <int>(values.size()); i++)
+            rootRatings[i].second = values[i].second;
+    }
+
+    result.nodeCount = m_nodeCount;
+
+    return true;
+}
+
+void ExpectimaxMovePolicy::prepareBuffers(const int plyCount)
+{
+    if (static_cast <int>(m_moves.size()) >= plyCount)
+        return;
+
+    m_moves.resize(plyCount);
+    m_ratings.resize(plyCount);
+    m_lines.resize(plyCount);
+    m_sampleLines.resize(plyCount);
+}
+
+bool ExpectimaxMovePolicy::isTimeOut()
+{
+    if (m_timeBudget.count() > 0 && m_nodeCount % movesBetweenTimeChecks == 0 &&
+        std::chrono::steady_clock::now() >= m_deadline)
+    {
+        m_isAborted = true;
+    }
+
+    return m_isAborted;
+}
+
+/*
+ * A chance node: the value of a move averaged over the samples of the new expected balls
+ * A move that deletes a streak adds no balls, so one sample is enough for it,
+ * and so is the last move of the search, since the new balls would not be played anyway
+ * The line of the first sample is left in the sample line of the ply
+ */
+float ExpectimaxMovePolicy::searchMove(const Move& move, const int depth, const int ply)
+{
+    auto& game = *m_game;
+
+    const auto sampleCount = (depth > 1) ? m_sampleCount : 1;
+    const auto positionSeed = RandomNumberGenerator::mixSeed(m_seed, game.getHash());
+
+    auto sum = 0.0f;
+    auto count = 0;
+
+    m_sampleLines[ply].clear();
+
+    for (auto sample = 0; sample < sampleCount; sample++)
+    {
+        game.setRandomSeed(RandomNumberGenerator::mixSeed(positionSeed, sample));
+
+        const auto randomState = game.getRandomState();
+        const auto oldScore = game.getScore();
+
+        game.applyMove(move);
+        m_nodeCount++;
+
+        auto value = static_cast <float>(game.getScore() - oldScore);
+
+        if (game.isGameOver())
+            value += gameOverValue;
+        else
+            value += searchPosition(depth - 1, ply + 1);
+
+        const auto isRandom = (game.getRandomState().words != randomState.words);
+        game.undo();
+
+        if (m_isAborted)
+            return 0.0f;
+
+        sum += value;
+        count++;
+
+        if (sample == 0 && depth > 1)
+            m_sampleLines[ply] = m_lines[ply + 1];
+
+        if (!isRandom)
+            break;
+    }
+
+    return sum / count;
+}
+
+/*
+ * A max node: the value of the best move, or of the position itself when no moves are left to search
+ * The line of the best move is left in the line of the ply
+ */
+float ExpectimaxMovePolicy::searchPosition(const int depth, const int ply)
+{
+    auto& line = m_lines[ply];
+    line.clear();
+
+    if (isTimeOut())
+        return 0.0f;
+
+    if (depth == 0)
+        return evaluate();
+
+    // A value from the table has no line, which only shortens the principal variation
+    // Only a value of the same depth is taken, so it is the value the search would give,
+    // and the moves do not depend on what else the table holds
+    TranspositionTable::Entry entry;
+    const auto key = RandomNumberGenerator::mixSeed(m_seed, m_game->getHash());
+
+    if (m_table.probe(key, entry) && entry.depth == depth)
+        return entry.value;
+
+    auto& moves = m_moves[ply];
+    m_game->generateMoves(moves);
+
+    if (moves.empty())
+        return gameOverValue;
+
+    selectMoves(ply, m_beamWidth);
+
+    auto bestValue = gameOverValue * 2;
+
+    for (const auto& rating : m_ratings[ply])
+    {
+        const auto& move = moves[rating.second];
+        const auto value = searchMove(move, depth, ply);
+
+        if (m_isAborted)
+            return 0.0f;
+
+        if (value > bestValue)
+        {
+            bestValue = value;
+
+            line.assign(1, move);
+            line.insert(line.end(), m_sampleLines[ply].begin(), m_sampleLines[ply].end());
+        }
+    }
+
+    m_table.store(key, TranspositionTable::Entry {bestValue, depth});
+    return bestValue;
+}
+
+/*
+ * Leaves the given count of the best rated moves of the ply in its ratings
+ */
+void ExpectimaxMovePolicy::selectMoves(const int ply, const int count)
+{
+    const auto& moves = m_moves[ply];
+    auto& ratings = m_ratings[ply];
+    ratings.clear();
+
+    for (auto i = 0; i < static_cast <int>(moves.size()); i++)
+        ratings.emplace_back(rateMove(m_game->getTileMap(), moves[i]), i);
+
+    const auto selectedCount = std::min(count, static_cast <int>(ratings.size()));
+
+    // Equal ratings keep the order of the moves, so the search does not depend on the sorting
+    std::partial_sort(ratings.begin(), ratings.begin() + selectedCount, ratings.end(),
+                      [](const auto& first, const auto& second)
+                      {
+                          return (first.first > second.first) || (first.first == second.first && first.second < second.second);
+                      });
+
+    ratings.resize(selectedCount);
+}
+
+/*
+ * A position is better with more free cells, which keep the game going,
+ * and with more balls next to the balls of the same color, which are the beginnings of streaks
+ * Expected balls count as the balls they are going to be
+ */
+float ExpectimaxMovePolicy::evaluate() const
+{
+    const auto& tileMap = m_game->getTileMap();
+    const auto stride = tileMap.getStride();
+    const int steps[] {1, stride, stride + 1, stride - 1};
+
+    auto freeCellCount = 0;
+    auto sameNeighbourCount = 0;
+
+    for (auto row = 0; row < tileMap.getHeight(); row++)
+    {
+        for (auto index = tileMap.toIndex(row, 0); index <= tileMap.toIndex(row, tileMap.getWidth() - 1); index++)
+        {
+            auto tile = tileMap[index];
+
+            if (tile == Tile::Empty)
+            {
+                freeCellCount++;
+                continue;
+            }
+
+            if (isExpected(tile))
+                tile = expectedToNormal(tile);
+
+            // Every pair is counted once, from its first ball
+            for (const auto step : steps)
+            {
+                const auto neighbour = tileMap[index + step];
+
+                if (neighbour == tile || (isExpected(neighbour) && expectedToNormal(neighbour) == tile))
+                    sameNeighbourCount++;
+            }
+        }
+    }
+
+    return freeCellWeight * freeCellCount + sameNeighbourWeight * sameNeighbourCount;
+}
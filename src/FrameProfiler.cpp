@@ -0,0 +1,209 @@
+#include "FrameProfiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    const char* const phaseNames[] {
+        "timer",
+        "events",
+        "info_panel",
+        "tile_map",
+        "hint",
+        "game_over_panel",
+        "overlay",
+        "display"
+    };
+
+    static_assert(std::size(phaseNames) == FrameProfiler::m_phaseCount);
+
+    /*
+     * The nearest rank, the values are reordered
+     */
+    double getPercentile(std::vector <std::uint32_t>& values, const double fraction)
+    {
+        if (values.empty())
+            return 0.0;
+
+        const auto rank = std::min(values.size() - 1, static_cast <size_t>(fraction * values.size()));
+        std::nth_element(values.begin(), values.begin() + rank, values.end());
+        return values[rank] / 1000.0;
+    }
+}
+
+std::uint32_t FrameSample::getTotalMicroseconds() const
+{
+    std::uint32_t total = 0;
+
+    for (const auto microseconds : phaseMicroseconds)
+        total += microseconds;
+
+    return total;
+}
+
+FrameProfiler::FrameProfiler() :
+    m_slots(std::make_unique <Slot[]>(m_capacity)),
+    m_frameCount(0),
+    m_phaseStart(std::chrono::steady_clock::now()),
+    m_phaseMicroseconds{}
+{
+    //ctor
+}
+
+FrameProfiler::~FrameProfiler()
+{
+    //dtor
+}
+
+void FrameProfiler::beginFrame()
+{
+    m_phaseMicroseconds.fill(0);
+    m_phaseStart = std::chrono::steady_clock::now();
+}
+
+void FrameProfiler::endPhase(const FramePhase phase)
+{
+    const auto now = std::chrono::steady_clock::now();
+    const auto microseconds = std::chrono::duration_cast <std::chrono::microseconds>(now - m_phaseStart).count();
+
+    m_phaseMicroseconds[static_cast <int>(phase)] += static_cast <std::uint32_t>(microseconds);
+    m_phaseStart = now;
+}
+
+/*
+ * The slot is marked as being written first, and the values are published with the final mark
+ */
+void FrameProfiler::endFrame(const int drawCallCount)
+{
+    const auto frame = m_frameCount.load(std::memory_order_relaxed);
+    auto& slot = m_slots[frame % m_capacity];
+
+    slot.sequence.store(2 * frame + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (auto i = 0; i < m_phaseCount; i++)
+        slot.values[i].store(m_phaseMicroseconds[i], std::memory_order_relaxed);
+
+    slot.values[m_phaseCount].store(static_cast <std::uint32_t>(drawCallCount), std::memory_order_relaxed);
+
+    slot.sequence.store(2 * frame + 2, std::memory_order_release);
+    m_frameCount.store(frame + 1, std::memory_order_release);
+}
+
+std::uint32_t FrameProfiler::getLastFrameMicroseconds() const
+{
+    std::uint32_t total = 0;
+
+    for (const auto microseconds : m_phaseMicroseconds)
+        total += microseconds;
+
+    return total;
+}
+
+/*
+ * Returns false if the frame has been overwritten before or while it was read
+ */
+bool FrameProfiler::readSlot(const std::uint64_t frame, FrameSample& sample) const
+{
+    const auto& slot = m_slots[frame % m_capacity];
+
+    if (slot.sequence.load(std::memory_order_acquire) != 2 * frame + 2)
+        return false;
+
+    sample.index = frame;
+
+    for (auto i = 0; i < m_phaseCount; i++)
+        sample.phaseMicroseconds[i] = slot.values[i].load(std::memory_order_relaxed);
+
+    sample.drawCallCount = slot.values[m_phaseCount].load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == 2 * frame + 2;
+}
+
+void FrameProfiler::getSamples(std::vector <FrameSample>& samples, const int maxCount) const
+{
+    samples.clear();
+
+    const auto frameCount = m_frameCount.load(std::memory_order_acquire);
+    const auto count = std::min <std::uint64_t>({frameCount, static_cast <std::uint64_t>(std::max(0, maxCount)), m_capacity});
+
+    FrameSample sample;
+
+    for (auto frame = frameCount - count; frame < frameCount; frame++)
+    {
+        if (readSlot(frame, sample))
+            samples.push_back(sample);
+    }
+}
+
+FrameStatistics FrameProfiler::getStatistics(const int frameCount) const
+{
+    std::vector <FrameSample> samples;
+    getSamples(samples, frameCount);
+
+    FrameStatistics statistics {static_cast <int>(samples.size()), 0, 0.0, 0.0, {}, 0.0};
+    std::vector <std::uint32_t> values;
+    values.reserve(samples.size());
+
+    auto drawCallCount = 0.0;
+
+    for (const auto& sample : samples)
+    {
+        if (sample.drawCallCount == 0)
+            continue;
+
+        values.push_back(sample.getTotalMicroseconds());
+        drawCallCount += sample.drawCallCount;
+    }
+
+    statistics.renderedFrameCount = static_cast <int>(values.size());
+    statistics.meanDrawCallCount = values.empty() ? 0.0 : drawCallCount / values.size();
+    statistics.frameMedian = getPercentile(values, 0.50);
+    statistics.frame99th = getPercentile(values, 0.99);
+
+    for (auto i = 0; i < m_phaseCount; i++)
+    {
+        values.clear();
+
+        for (const auto& sample : samples)
+            values.push_back(sample.phaseMicroseconds[i]);
+
+        statistics.phase99th[i] = getPercentile(values, 0.99);
+    }
+
+    return statistics;
+}
+
+void FrameProfiler::writeCsv(const std::string& path) const
+{
+    std::vector <FrameSample> samples;
+    getSamples(samples, m_capacity);
+
+    std::ofstream file(path);
+    if (!file)
+        throw std::runtime_error("Cannot create file " + path);
+
+    file << "frame";
+    for (const auto name : phaseNames)
+        file << ',' << name << "_us";
+    file << ",total_us,draw_calls\n";
+
+    for (const auto& sample : samples)
+    {
+        file << sample.index;
+        for (const auto microseconds : sample.phaseMicroseconds)
+            file << ',' << microseconds;
+        file << ',' << sample.getTotalMicroseconds() << ',' << sample.drawCallCount << '\n';
+    }
+
+    if (!file)
+        throw std::runtime_error("Cannot write file " + path);
+}
+
+const char* FrameProfiler::getName(const FramePhase phase)
+{
+    return phaseNames[static_cast <int>(phase)];
+}
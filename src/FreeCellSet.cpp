@@ -0,0 +1,38 @@
+#include "FreeCellSet.hpp"
+
+FreeCellSet::FreeCellSet()
+{
+    //ctor
+}
+
+FreeCellSet::~FreeCellSet()
+{
+    //dtor
+}
+
+/*
+ * Collects the empty cells of the whole tilemap
+ * The array is reserved for all the cells, so later insertions never allocate
+ */
+void FreeCellSet::rebuild(const Board& board)
+{
+    m_cells.clear();
+    m_cells.reserve(board.getWidth() * board.getHeight());
+    m_positions.assign(board.getCellCount(), -1);
+
+    for (auto index = 0; index < board.getCellCount(); index++)
+    {
+        if (board[index] == Tile::Empty)
+            insert(index);
+    }
+}
+
+void FreeCellSet::rebuild(const Board& board, const std::vector <int>& cells)
+{
+    m_cells.clear();
+    m_cells.reserve(board.getWidth() * board.getHeight());
+    m_positions.assign(board.getCellCount(), -1);
+
+    for (const auto index : cells)
+        insert(index);
+}
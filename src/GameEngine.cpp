@@ -1,20 +1,127 @@
 #include "GameEngine.hpp"
+#include "Instrumentation.hpp"
+#include "Logger.hpp"
 
-GameEngine::GameEngine() : m_newBallCountOnMove(3)
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <cstring>
+
+namespace
+{
+    // "CLSN" read as a little-endian number
+    constexpr std::uint64_t snapshotSignature = 0x4E534C43;
+    constexpr std::uint64_t snapshotVersion = 1;
+    constexpr std::size_t snapshotHeaderSize = 64;
+
+    constexpr int additionalMoveFlag = 1;
+
+    // mt19937 is restored by drawing every number again, so a damaged count must not make loading endless
+    constexpr std::uint64_t maxMersenneTwisterDrawCount = 1ull << 30;
+}
+
+GameEngine::GameEngine() : m_tileMapVersion(0), m_positionVersion(0), m_hash(0), m_dirtyRegion{0, 0, 0, 0}, m_chunkCountInRow(0), m_undoCount(0), m_isRecording(false), m_newBallCountOnMove(3)
 {
     //ctor
 }
 
 GameEngine::~GameEngine()
 {
-    //dtor
+    // A failed write of the replay cannot be reported from here
+    try
+    {
+        endRecordedGame();
+    }
+    catch (const std::exception&)
+    {
+    }
+}
+
+void GameEngine::setRandomSeed(const std::uint64_t seed)
+{
+    m_random.setSeed(seed);
+}
+
+void GameEngine::setRandomAlgorithm(const RandomNumberGenerator::Algorithm algorithm)
+{
+    m_random.setAlgorithm(algorithm);
+}
+
+RandomNumberGenerator::State GameEngine::getRandomState() const
+{
+    return m_random.getState();
+}
+
+void GameEngine::setRandomState(const RandomNumberGenerator::State& state)
+{
+    m_random.setState(state);
+}
+
+void GameEngine::setReplayRecorder(ReplayRecorder* recorder)
+{
+    endRecordedGame();
+    m_replay.pointer = recorder;
+}
+
+void GameEngine::setLogger(Logger* logger)
+{
+    m_logger.pointer = logger;
+}
+
+/*
+ * The score is known only to the engine, so it ends the games it records
+ */
+void GameEngine::endRecordedGame()
+{
+    if (isRecorded())
+        m_replay.pointer->endGame(m_score);
+}
+
+/*
+ * A loaded game has no start in the replay, so its actions are not recorded either
+ */
+bool GameEngine::isRecorded() const
+{
+    return m_replay.pointer != nullptr && m_replay.pointer->isGameStarted();
 }
 
 void GameEngine::startNewGame(const int widthInTiles, const int heightInTiles, const int colorCount)
 {
-    m_tileMap.resize(heightInTiles, std::vector <Tile>(widthInTiles, Tile::Empty));
-    for (auto& row : m_tileMap)
-        std::fill(row.begin(), row.end(), Tile::Empty);
+    if (widthInTiles < m_minSizeInTiles || widthInTiles > m_maxSizeInTiles ||
+        heightInTiles < m_minSizeInTiles || heightInTiles > m_maxSizeInTiles)
+    {
+        throw std::runtime_error("The board must be from " + std::to_string(m_minSizeInTiles) +
+                                 " to " + std::to_string(m_maxSizeInTiles) + " tiles wide and high");
+    }
+
+    // Every color has its tiles, bitboards and sprites, so there are no more colors than tiles for them
+    const auto maxColorCount = static_cast <int>(Tile::ColorEnd - Tile::ColorOne);
+
+    if (colorCount < 1 || colorCount > maxColorCount)
+        throw std::runtime_error("The number of colors must be from 1 to " + std::to_string(maxColorCount));
+
+    // A generator set to a state, e.g. by loading a game, has no seed to log, and zero is logged instead
+    if (m_logger.pointer != nullptr)
+    {
+        const auto seed = m_random.hasSeed() ? m_random.getSeed() : 0;
+        m_logger.pointer->write(LogLevel::Info, LogEvent::GameStarted,
+                                {widthInTiles, heightInTiles, colorCount,
+                                 static_cast <std::int32_t>(seed), static_cast <std::int32_t>(seed >> 32)});
+    }
+
+    // The generator is recorded before it drops the first balls
+    if (m_replay.pointer != nullptr)
+    {
+        endRecordedGame();
+        m_replay.pointer->startGame(widthInTiles, heightInTiles, colorCount, m_random);
+    }
+
+    m_tileMap.resize(widthInTiles, heightInTiles);
+
+    m_colorCount = colorCount;
+    m_minStreakLength = (widthInTiles < heightInTiles) ? (widthInTiles - 4) : (heightInTiles - 4);
+
+    rebuildTileMapState();
 
     m_selection = std::make_pair(-1, -1);
     m_state = GameState::FirstPick;
@@ -23,14 +130,305 @@ void GameEngine::startNewGame(const int widthInTiles, const int heightInTiles, c
     m_timeElapsedInSeconds = 0;
     m_score = 0;
 
-    m_colorCount = colorCount;
-    m_minStreakLength = (widthInTiles < heightInTiles) ? (widthInTiles - 4) : (heightInTiles - 4);
-
     addExpectedBalls(m_newBallCountOnMove);
     transformExpectedBalls();
     addExpectedBalls(m_newBallCountOnMove);
 }
 
+/*
+ * Everything kept along with the tilemap is built from it again, and the history is cleared
+ * The tilemap, the number of colors and the minimal length of a streak must be set
+ */
+void GameEngine::rebuildTileMapState()
+{
+    const auto widthInTiles = m_tileMap.getWidth();
+    const auto heightInTiles = m_tileMap.getHeight();
+
+    m_tileMapVersion++;
+    m_positionVersion++;
+    m_hash = 0;
+    m_dirtyRegion = TileRectangle {0, 0, heightInTiles, widthInTiles};
+    m_passableRegions.rebuild(m_tileMap);
+    m_pathFinder.resize(m_tileMap);
+    m_freeCells.rebuild(m_tileMap);
+    m_expectedCells.clear();
+
+#ifdef COLORLINES_BITBOARD_STREAKS
+    m_ballBitBoards.resize(m_tileMap, m_colorCount, m_minStreakLength);
+#endif
+
+    // The frame has no place in the hash, so only the real cells are walked
+    for (auto row = 0; row < heightInTiles; row++)
+    {
+        for (auto index = m_tileMap.toIndex(row, 0); index <= m_tileMap.toIndex(row, widthInTiles - 1); index++)
+        {
+            const auto tile = m_tileMap[index];
+            if (tile == Tile::Empty)
+                continue;
+
+            m_hash ^= getTileKey(index, tile);
+
+            if (isExpected(tile))
+                m_expectedCells.push_back(index);
+
+#ifdef COLORLINES_BITBOARD_STREAKS
+            m_ballBitBoards.update(index, Tile::Empty, tile);
+#endif
+        }
+    }
+
+    // The whole new tilemap is dirty
+    m_chunkCountInRow = (widthInTiles + m_chunkSizeInTiles - 1) / m_chunkSizeInTiles;
+    const auto chunkCount = m_chunkCountInRow * ((heightInTiles + m_chunkSizeInTiles - 1) / m_chunkSizeInTiles);
+
+    m_isChunkDirty.assign(chunkCount, true);
+    m_dirtyChunks.resize(chunkCount);
+
+    for (auto i = 0; i < chunkCount; i++)
+        m_dirtyChunks[i] = i;
+
+    m_history.clear();
+    m_changes.clear();
+    m_undoCount = 0;
+}
+
+std::size_t GameEngine::getSnapshotSize() const
+{
+    return snapshotHeaderSize + m_tileMap.getCellCount() + 4 * static_cast <std::size_t>(m_freeCells.getCount());
+}
+
+std::size_t GameEngine::save(std::span <unsigned char> snapshot) const
+{
+    const auto size = getSnapshotSize();
+    if (snapshot.size() < size)
+        throw std::runtime_error("The buffer is too small for the snapshot");
+
+    const auto random = m_random.getState();
+    const auto data = snapshot.data();
+
+    putInteger(data, snapshotSignature, 4);
+    putInteger(data + 4, snapshotVersion, 4);
+    putInteger(data + 8, m_tileMap.getWidth(), 2);
+    putInteger(data + 10, m_tileMap.getHeight(), 2);
+    putInteger(data + 12, m_colorCount, 1);
+    putInteger(data + 13, static_cast <std::uint64_t>(m_state), 1);
+    putInteger(data + 14, m_isAdditionalMoveAvailable ? additionalMoveFlag : 0, 1);
+    putInteger(data + 15, static_cast <std::uint64_t>(random.algorithm), 1);
+    putInteger(data + 16, m_minStreakLength, 4);
+    putInteger(data + 20, static_cast <std::uint32_t>(m_score), 4);
+    putInteger(data + 24, static_cast <std::uint32_t>(m_timeElapsedInSeconds), 4);
+    putInteger(data + 28, static_cast <std::uint16_t>(m_selection.first), 2);
+    putInteger(data + 30, static_cast <std::uint16_t>(m_selection.second), 2);
+
+    for (auto i = 0; i < 4; i++)
+        putInteger(data + 32 + 8 * i, random.words[i], 8);
+
+    const auto cells = m_tileMap.getCells();
+    std::memcpy(data + snapshotHeaderSize, cells.data(), cells.size());
+
+    auto freeCellData = data + snapshotHeaderSize + cells.size();
+    for (const auto index : m_freeCells.getCells())
+    {
+        putInteger(freeCellData, static_cast <std::uint32_t>(index), 4);
+        freeCellData += 4;
+    }
+
+    return size;
+}
+
+void GameEngine::load(std::span <const unsigned char> snapshot)
+{
+    std::vector <int> freeCells;
+    validateSnapshot(snapshot, freeCells);
+
+    const auto data = snapshot.data();
+    const auto widthInTiles = static_cast <int>(getInteger(data + 8, 2));
+    const auto heightInTiles = static_cast <int>(getInteger(data + 10, 2));
+
+    endRecordedGame();
+
+    m_tileMap.resize(widthInTiles, heightInTiles);
+    const auto cells = m_tileMap.getCells();
+    std::memcpy(cells.data(), data + snapshotHeaderSize, cells.size());
+
+    m_colorCount = static_cast <int>(getInteger(data + 12, 1));
+    m_minStreakLength = static_cast <int>(getInteger(data + 16, 4));
+
+    rebuildTileMapState();
+    m_freeCells.rebuild(m_tileMap, freeCells);
+
+    m_state = static_cast <GameState>(getInteger(data + 13, 1));
+    m_isAdditionalMoveAvailable = (getInteger(data + 14, 1) & additionalMoveFlag) != 0;
+    m_score = static_cast <std::int32_t>(getInteger(data + 20, 4));
+    m_timeElapsedInSeconds = static_cast <std::int32_t>(getInteger(data + 24, 4));
+    m_selection = std::make_pair(static_cast <int>(static_cast <std::int16_t>(getInteger(data + 28, 2))),
+                                 static_cast <int>(static_cast <std::int16_t>(getInteger(data + 30, 2))));
+
+    RandomNumberGenerator::State random;
+    random.algorithm = static_cast <RandomNumberGenerator::Algorithm>(getInteger(data + 15, 1));
+
+    for (auto i = 0; i < 4; i++)
+        random.words[i] = getInteger(data + 32 + 8 * i, 8);
+
+    m_random.setState(random);
+}
+
+/*
+ * Everything the engine relies on is checked, so a damaged or forged snapshot is never played:
+ * the frame is whole, every ball has one of the colors of the game,
+ * a ball is selected only where the selection is and only while the second pick is awaited,
+ * and every empty cell is listed once
+ * The empty cells are put into the given buffer in their order
+ */
+void GameEngine::validateSnapshot(std::span <const unsigned char> snapshot, std::vector <int>& freeCells)
+{
+    const auto data = snapshot.data();
+
+    if (snapshot.size() < snapshotHeaderSize ||
+        getInteger(data, 4) != snapshotSignature ||
+        getInteger(data + 4, 4) != snapshotVersion)
+    {
+        throw std::runtime_error("Not a snapshot of a game");
+    }
+
+    const auto widthInTiles = static_cast <int>(getInteger(data + 8, 2));
+    const auto heightInTiles = static_cast <int>(getInteger(data + 10, 2));
+    const auto colorCount = static_cast <int>(getInteger(data + 12, 1));
+    const auto state = getInteger(data + 13, 1);
+    const auto algorithm = getInteger(data + 15, 1);
+    const auto minStreakLength = static_cast <int>(getInteger(data + 16, 4));
+    const auto selectedRow = static_cast <int>(static_cast <std::int16_t>(getInteger(data + 28, 2)));
+    const auto selectedColumn = static_cast <int>(static_cast <std::int16_t>(getInteger(data + 30, 2)));
+
+    const auto stride = static_cast <std::size_t>(widthInTiles) + 2;
+
+    if (widthInTiles < m_minSizeInTiles || widthInTiles > m_maxSizeInTiles ||
+        heightInTiles < m_minSizeInTiles || heightInTiles > m_maxSizeInTiles ||
+        snapshot.size() < snapshotHeaderSize + stride * (heightInTiles + 2) ||
+        colorCount < 1 || colorCount > static_cast <int>(Tile::ColorEnd - Tile::ColorOne) ||
+        state > static_cast <std::uint64_t>(GameState::GameOver) ||
+        algorithm > static_cast <std::uint64_t>(RandomNumberGenerator::Algorithm::MersenneTwister) ||
+        minStreakLength < 1 || minStreakLength > std::max(widthInTiles, heightInTiles) ||
+        (algorithm == static_cast <std::uint64_t>(RandomNumberGenerator::Algorithm::MersenneTwister) &&
+         getInteger(data + 40, 8) > maxMersenneTwisterDrawCount))
+    {
+        throw std::runtime_error("Damaged snapshot of a game");
+    }
+
+    const auto isSecondPick = (state == static_cast <std::uint64_t>(GameState::SecondPick));
+    const auto isSelectionInside = (selectedRow >= 0 && selectedRow < heightInTiles &&
+                                    selectedColumn >= 0 && selectedColumn < widthInTiles);
+
+    if (isSecondPick ? !isSelectionInside : (selectedRow != -1 || selectedColumn != -1))
+        throw std::runtime_error("Damaged snapshot of a game");
+
+    const auto tiles = data + snapshotHeaderSize;
+    const auto endColor = Tile::ColorOne + static_cast <Tile>(colorCount);
+
+    // The tiles allowed in the real cells, a selected ball is checked on its own
+    std::array <bool, 256> isAllowed {};
+    isAllowed[static_cast <int>(Tile::Empty)] = true;
+
+    for (auto tile = Tile::ColorOne; tile < endColor; tile++)
+    {
+        isAllowed[static_cast <int>(tile)] = true;
+        isAllowed[static_cast <int>(normalToExpected(tile))] = true;
+    }
+
+    if (isSecondPick)
+    {
+        const auto tile = static_cast <Tile>(tiles[(selectedRow + 1) * stride + selectedColumn + 1]);
+        if (!isSelected(tile) || selectedToNormal(tile) >= endColor)
+            throw std::runtime_error("Damaged snapshot of a game");
+    }
+
+    // Every row is a border cell, the real cells and a border cell, so the frame is checked at the edges
+    const auto isBorderRow = [=](const int row)
+    {
+        return std::all_of(tiles + row * stride, tiles + (row + 1) * stride,
+                           [](const unsigned char tile) { return static_cast <Tile>(tile) == Tile::Border; });
+    };
+
+    if (!isBorderRow(0) || !isBorderRow(heightInTiles + 1))
+        throw std::runtime_error("Damaged snapshot of a game");
+
+    auto emptyCount = 0;
+
+    for (auto row = 0; row < heightInTiles; row++)
+    {
+        const auto first = tiles + (row + 1) * stride;
+
+        if (static_cast <Tile>(first[0]) != Tile::Border || static_cast <Tile>(first[widthInTiles + 1]) != Tile::Border)
+            throw std::runtime_error("Damaged snapshot of a game");
+
+        for (auto column = 0; column < widthInTiles; column++)
+        {
+            const auto tile = first[column + 1];
+
+            if (!isAllowed[tile] && !(isSecondPick && row == selectedRow && column == selectedColumn))
+                throw std::runtime_error("Damaged snapshot of a game");
+
+            emptyCount += (static_cast <Tile>(tile) == Tile::Empty);
+        }
+    }
+
+    const auto cellCount = stride * (heightInTiles + 2);
+    const auto freeCellData = tiles + cellCount;
+
+    if (snapshot.size() != snapshotHeaderSize + cellCount + 4 * static_cast <std::size_t>(emptyCount))
+        throw std::runtime_error("Damaged snapshot of a game");
+
+    std::vector <unsigned char> isListed(cellCount, 0);
+    freeCells.resize(emptyCount);
+
+    for (auto i = 0; i < emptyCount; i++)
+    {
+        const auto index = getInteger(freeCellData + 4 * i, 4);
+
+        if (index >= cellCount || static_cast <Tile>(tiles[index]) != Tile::Empty || isListed[index])
+            throw std::runtime_error("Damaged snapshot of a game");
+
+        isListed[index] = 1;
+        freeCells[i] = static_cast <int>(index);
+    }
+}
+
+/*
+ * The buffers of the move generation and of the path search are scratch, so they are not copied either
+ */
+void GameEngine::copyPosition(const GameEngine& other)
+{
+    m_tileMap = other.m_tileMap;
+    m_tileMapVersion = other.m_tileMapVersion;
+    m_positionVersion = other.m_positionVersion;
+    m_hash = other.m_hash;
+    m_dirtyRegion = other.m_dirtyRegion;
+    m_dirtyChunks = other.m_dirtyChunks;
+    m_isChunkDirty = other.m_isChunkDirty;
+    m_chunkCountInRow = other.m_chunkCountInRow;
+    m_passableRegions = other.m_passableRegions;
+    m_freeCells = other.m_freeCells;
+    m_expectedCells = other.m_expectedCells;
+
+    m_selection = other.m_selection;
+    m_state = other.m_state;
+    m_isAdditionalMoveAvailable = other.m_isAdditionalMoveAvailable;
+    m_timeElapsedInSeconds = other.m_timeElapsedInSeconds;
+    m_score = other.m_score;
+    m_colorCount = other.m_colorCount;
+    m_minStreakLength = other.m_minStreakLength;
+    m_random = other.m_random;
+
+    m_history.clear();
+    m_changes.clear();
+    m_undoCount = 0;
+    m_isRecording = false;
+
+#ifdef COLORLINES_BITBOARD_STREAKS
+    m_ballBitBoards = other.m_ballBitBoards;
+#endif
+}
+
 /*
  * The entry point for making moves
  */
@@ -40,11 +438,16 @@ void GameEngine::processPick(const int row, const int column)
     // to process different game situations differently
     // in a way easy to understand
 
+    if (isRecorded())
+        m_replay.pointer->recordPick(row, column);
+
+    const auto index = m_tileMap.toIndex(row, column);
+
     switch (m_state)
     {
         case GameState::FirstPick:
         {
-            if (!isBall(m_tileMap[row][column]))
+            if (!isBall(m_tileMap[index]))
                 break;
 
             selectTile(row, column);
@@ -62,32 +465,15 @@ void GameEngine::processPick(const int row, const int column)
             }
 
             // Process move if player selects a free cell
-            else if (isTilePassable(m_tileMap[row][column]))
+            else if (isTilePassable(m_tileMap[index]))
             {
-                if (!pathExists(m_selection.first, m_selection.second, row, column))
+                const auto sourceIndex = m_tileMap.toIndex(m_selection.first, m_selection.second);
+
+                if (!pathExists(sourceIndex, index))
                     break;
 
-                swapSelectedWith(row, column);
                 deselectTile();
-                m_state = GameState::FirstPick;
-
-                m_isAdditionalMoveAvailable = false;
-                auto score = deleteStreaks(row, column);
-
-                if (score > 0)
-                {
-                    increaseScore(score);
-                    m_isAdditionalMoveAvailable = true;
-                }
-
-                if (!m_isAdditionalMoveAvailable)
-                {
-                    transformExpectedBalls();
-                    auto ballsAdded = addExpectedBalls(m_newBallCountOnMove);
-
-                    if (ballsAdded == 0)
-                        m_state = GameState::GameOver;
-                }
+                makeMove(sourceIndex, index);
             }
 
             // Select another ball if player selects it
@@ -107,70 +493,269 @@ void GameEngine::processPick(const int row, const int column)
 
 void GameEngine::selectTile(const int row, const int column)
 {
-    m_tileMap[row][column] = normalToSelected(m_tileMap[row][column]);
+    const auto index = m_tileMap.toIndex(row, column);
+
+    setTile(index, normalToSelected(m_tileMap[index]));
     m_selection = std::make_pair(row, column);
 }
 
 void GameEngine::deselectTile()
 {
-    auto row = m_selection.first;
-    auto column = m_selection.second;
+    const auto index = m_tileMap.toIndex(m_selection.first, m_selection.second);
 
-    m_tileMap[row][column] = selectedToNormal(m_tileMap[row][column]);
+    setTile(index, selectedToNormal(m_tileMap[index]));
     m_selection = std::make_pair(-1, -1);
 }
 
-void GameEngine::swapSelectedWith(const int rowNew, const int columnNew)
+/*
+ * Swaps the ball with the destination, which can hold an expected ball,
+ * then deletes streaks or adds new balls
+ * The move must be possible and no tile must be selected
+ */
+void GameEngine::makeMove(const int sourceIndex, const int destinationIndex)
 {
-    auto rowOld = m_selection.first;
-    auto columnOld = m_selection.second;
+    COLORLINES_TIME(MakeMove);
+
+    // A new move replaces the taken back ones
+    m_history.resize(m_undoCount);
+    m_changes.resize(getChangeBegin(m_undoCount));
+
+    MoveRecord record;
+    record.oldScore = m_score;
+    record.wasAdditionalMoveAvailable = m_isAdditionalMoveAvailable;
+    record.oldRandomState = m_random.getState();
+
+    m_isRecording = true;
+
+    const auto sourceTile = m_tileMap[sourceIndex];
+    setTile(sourceIndex, m_tileMap[destinationIndex]);
+    setTile(destinationIndex, sourceTile);
+
+    m_state = GameState::FirstPick;
 
-    std::swap(m_tileMap[rowNew][columnNew], m_tileMap[rowOld][columnOld]);
-    m_selection = std::make_pair(rowNew, columnNew);
+    m_isAdditionalMoveAvailable = false;
+    auto score = deleteStreaks(destinationIndex);
+
+    if (score > 0)
+    {
+        increaseScore(score);
+        m_isAdditionalMoveAvailable = true;
+    }
+
+    if (!m_isAdditionalMoveAvailable)
+    {
+        transformExpectedBalls();
+        auto ballsAdded = addExpectedBalls(m_newBallCountOnMove);
+
+        if (ballsAdded == 0)
+            m_state = GameState::GameOver;
+
+        if (m_logger.pointer != nullptr)
+            m_logger.pointer->write(LogLevel::Debug, LogEvent::Spawn, {ballsAdded, m_freeCells.getCount(), 0, 0, 0});
+    }
+
+    m_isRecording = false;
+
+    record.changeEnd = static_cast <int>(m_changes.size());
+    record.newScore = m_score;
+    record.newState = m_state;
+    record.isAdditionalMoveAvailable = m_isAdditionalMoveAvailable;
+    record.newRandomState = m_random.getState();
+
+    m_history.push_back(record);
+    m_undoCount++;
+    m_positionVersion++;
+
+    // The move is logged after its streaks and new balls with the score it has reached
+    if (m_logger.pointer != nullptr)
+    {
+        m_logger.pointer->write(LogLevel::Debug, LogEvent::Move,
+                                {m_tileMap.toRow(sourceIndex), m_tileMap.toColumn(sourceIndex),
+                                 m_tileMap.toRow(destinationIndex), m_tileMap.toColumn(destinationIndex), m_score});
+
+        if (m_state == GameState::GameOver)
+            m_logger.pointer->write(LogLevel::Info, LogEvent::GameOver, {m_score, m_timeElapsedInSeconds, m_undoCount, 0, 0});
+    }
+}
+
+int GameEngine::getChangeBegin(const int moveIndex) const
+{
+    return (moveIndex == 0) ? 0 : m_history[moveIndex - 1].changeEnd;
 }
 
 /*
- * The count of free cells can be less than the required number of balls
- * So, it adds balls as maximum as possible
- * Returns the number of added balls
+ * Only the tiles changed by the move are set back, in reverse order, the free cells get their order back,
+ * and the generator continues from where it was before the move, so making the move again gives the same balls
  */
-int GameEngine::addExpectedBalls(const int maxCount)
+bool GameEngine::undo()
 {
-    /* We create a vector of coordinates of empty cells
-     * to randomly choose a pair of coordinates
-     * to place a ball in the randomly selected cell
-     */
+    if (!canUndo())
+        return false;
+
+    if (isRecorded())
+        m_replay.pointer->recordUndo();
 
-    std::vector <std::pair <int, int>> emptyTiles;
-    emptyTiles.reserve(m_tileMap.size() * m_tileMap[0].size());
+    if (m_state == GameState::SecondPick)
+        deselectTile();
 
-    for (auto row = 0; row < m_tileMap.size(); row++)
+    m_undoCount--;
+    const auto& record = m_history[m_undoCount];
+
+    // A cell emptied again is appended to the free cells and then moved back to where it was erased from,
+    // while a cell filled again is the last one, as every later change has been undone already
+    for (auto i = record.changeEnd - 1; i >= getChangeBegin(m_undoCount); i--)
     {
-        for (auto column = 0; column < m_tileMap[row].size(); column++)
-        {
-            if (m_tileMap[row][column] == Tile::Empty)
-                emptyTiles.push_back(std::make_pair(row, column));
-        }
+        const auto& change = m_changes[i];
+        setTile(change.index, change.oldTile);
+
+        if (change.oldTile == Tile::Empty && change.newTile != Tile::Empty)
+            m_freeCells.moveLastTo(change.freeCellPosition);
     }
 
-    const int countAdded = (maxCount > static_cast <int>(emptyTiles.size())) ? static_cast <int>(emptyTiles.size()) : maxCount;
+    m_score = record.oldScore;
+    m_state = GameState::FirstPick;
+    m_isAdditionalMoveAvailable = record.wasAdditionalMoveAvailable;
+    m_random.setState(record.oldRandomState);
+    m_positionVersion++;
+
+    return true;
+}
+
+bool GameEngine::redo()
+{
+    if (!canRedo())
+        return false;
+
+    if (isRecorded())
+        m_replay.pointer->recordRedo();
+
+    if (m_state == GameState::SecondPick)
+        deselectTile();
+
+    const auto& record = m_history[m_undoCount];
+
+    for (auto i = getChangeBegin(m_undoCount); i < record.changeEnd; i++)
+        setTile(m_changes[i].index, m_changes[i].newTile);
+
+    m_undoCount++;
+
+    m_score = record.newScore;
+    m_state = record.newState;
+    m_isAdditionalMoveAvailable = record.isAdditionalMoveAvailable;
+    m_random.setState(record.newRandomState);
+    m_positionVersion++;
 
-    for (auto i = 0; i < countAdded; )
+    return true;
+}
+
+bool GameEngine::canUndo() const
+{
+    return m_undoCount > 0;
+}
+
+bool GameEngine::canRedo() const
+{
+    return m_undoCount < static_cast <int>(m_history.size());
+}
+
+/*
+ * Every change of the tilemap goes through here
+ */
+void GameEngine::setTile(const int index, const Tile tile)
+{
+#ifdef COLORLINES_BITBOARD_STREAKS
+    m_ballBitBoards.update(index, m_tileMap[index], tile);
+#endif
+
+    const auto oldTile = m_tileMap[index];
+
+    if (m_isRecording)
+        m_changes.push_back(TileChange {index, oldTile, tile, m_freeCells.getPosition(index)});
+
+    const auto wasPassable = isTilePassable(oldTile);
+    m_tileMap[index] = tile;
+    m_tileMapVersion++;
+    m_hash ^= getTileKey(index, oldTile) ^ getTileKey(index, tile);
+
+    markDirty(index);
+
+    if (isExpected(tile) && !isExpected(oldTile))
+        m_expectedCells.push_back(index);
+    else if (isExpected(oldTile) && !isExpected(tile))
+        m_expectedCells.erase(std::find(m_expectedCells.begin(), m_expectedCells.end(), index));
+
+    if (oldTile == Tile::Empty && tile != Tile::Empty)
+        m_freeCells.erase(index);
+    else if (oldTile != Tile::Empty && tile == Tile::Empty)
+        m_freeCells.insert(index);
+
+    if (wasPassable != isTilePassable(tile))
+        m_passableRegions.update(m_tileMap, index);
+}
+
+void GameEngine::markDirty(const int index)
+{
+    const auto row = m_tileMap.toRow(index);
+    const auto column = m_tileMap.toColumn(index);
+
+    if (m_dirtyRegion.isEmpty())
+    {
+        m_dirtyRegion = TileRectangle {row, column, row + 1, column + 1};
+    }
+    else
     {
-        auto index = m_random.getInteger(0, emptyTiles.size());
+        m_dirtyRegion.top = std::min(m_dirtyRegion.top, row);
+        m_dirtyRegion.left = std::min(m_dirtyRegion.left, column);
+        m_dirtyRegion.bottom = std::max(m_dirtyRegion.bottom, row + 1);
+        m_dirtyRegion.right = std::max(m_dirtyRegion.right, column + 1);
+    }
 
-        auto row = emptyTiles[index].first;
-        auto column = emptyTiles[index].second;
+    const auto chunk = (row / m_chunkSizeInTiles) * m_chunkCountInRow + column / m_chunkSizeInTiles;
 
-        // We do not delete cells that we have filled, so there's a workaround
-        if (m_tileMap[row][column] != Tile::Empty)
-            continue;
+    if (!m_isChunkDirty[chunk])
+    {
+        m_isChunkDirty[chunk] = true;
+        m_dirtyChunks.push_back(chunk);
+    }
+}
+
+/*
+ * The key of a tile in a cell is mixed from the two of them instead of being kept in a table,
+ * so engines of any size share the keys and copying an engine copies no table
+ * Empty cells have no key, so an empty tilemap has the zero hash
+ */
+std::uint64_t GameEngine::getTileKey(const int index, const Tile tile)
+{
+    if (tile == Tile::Empty)
+        return 0;
+
+    const auto hashedTile = isSelected(tile) ? selectedToNormal(tile) : tile;
+    return RandomNumberGenerator::mixSeed(static_cast <std::uint64_t>(index), static_cast <std::uint64_t>(hashedTile));
+}
 
-        m_tileMap[row][column] = m_random.getTile(Tile::ExpectedColorOne,
-                                                  Tile::ExpectedColorOne + static_cast <Tile>(m_colorCount));
-        i++;
+/*
+ * The count of free cells can be less than the required number of balls
+ * So, it adds balls as maximum as possible
+ * Returns the number of added balls
+ */
+int GameEngine::addExpectedBalls(const int maxCount)
+{
+    COLORLINES_TIME(AddExpectedBalls);
+
+    // Every chosen cell stops being empty and leaves the set of free cells,
+    // so the next ball is always chosen among the remaining ones without retries
+
+    const auto countAdded = std::min(maxCount, m_freeCells.getCount());
+
+    for (auto i = 0; i < countAdded; i++)
+    {
+        const auto index = m_freeCells[m_random.getInteger(0, m_freeCells.getCount())];
+
+        setTile(index, m_random.getTile(Tile::ExpectedColorOne,
+                                        Tile::ExpectedColorOne + static_cast <Tile>(m_colorCount)));
     }
 
+    COLORLINES_COUNT(ExpectedBallsAdded, countAdded);
     return countAdded;
 }
 
@@ -181,67 +766,55 @@ int GameEngine::addExpectedBalls(const int maxCount)
  */
 void GameEngine::transformExpectedBalls()
 {
-    for (auto row = 0; row < m_tileMap.size(); row++)
+    COLORLINES_TIME(TransformExpectedBalls);
+
+    // The balls are transformed in the order of the tilemap, as a scan of the whole tilemap would do,
+    // so the streaks and the scores do not depend on the order the balls were added in
+    // Transforming changes the list, so a sorted copy of it is walked
+    m_transformedCells.assign(m_expectedCells.begin(), m_expectedCells.end());
+    std::sort(m_transformedCells.begin(), m_transformedCells.end());
+
+    for (const auto index : m_transformedCells)
     {
-        for (auto column = 0; column < m_tileMap.size(); column++)
+        if (isExpected(m_tileMap[index]))
         {
-            if (isExpected(m_tileMap[row][column]))
-            {
-                m_tileMap[row][column] = expectedToNormal(m_tileMap[row][column]);
+            setTile(index, expectedToNormal(m_tileMap[index]));
+            COLORLINES_COUNT(BallsTransformed, 1);
 
-                auto score = deleteStreaks(row, column);
-                increaseScore(score);
-            }
+            auto score = deleteStreaks(index);
+            increaseScore(score);
         }
     }
 }
 
 bool GameEngine::isTilePassable(const Tile t) const
 {
-    return (t == Tile::Empty || isExpected(t));
+    return isPassable(t);
 }
 
 /*
- * Uses BFS to find if a path between to cells exists
+ * A path between two cells exists if a free neighbour of the ball
+ * is in the same passable region as the destination
  * Does not count diagonal moves, only horizontal and vertical
+ * The border is not passable, so the neighbours are always inside the buffer
  */
-bool GameEngine::pathExists(const int sourceRow,
-                            const int sourceColumn,
-                            const int destinationRow,
-                            const int destinationColumn) const
+bool GameEngine::pathExists(const int sourceIndex, const int destinationIndex) const
 {
-    const std::vector <std::pair <int, int>> offsets {{-1, 0}, {0, -1}, {1, 0}, {0, 1}};
+    COLORLINES_TIME(PathExists);
+    COLORLINES_COUNT(PathExistsCalls, 1);
 
-    std::vector <std::pair <int, int>> visited;
-    visited.reserve(m_tileMap.size() * m_tileMap[0].size());
+    const auto stride = m_tileMap.getStride();
+    const int offsets[] {-stride, -1, stride, 1};
 
-    std::queue <std::pair <int, int>> q;
-    q.push(std::make_pair(sourceRow, sourceColumn));
+    const auto destinationRegion = m_passableRegions.getRegion(destinationIndex);
 
-    while (q.size() > 0)
+    for (const auto offset : offsets)
     {
-        auto p = q.front();
-        q.pop();
+        const auto nextIndex = sourceIndex + offset;
+        COLORLINES_COUNT(PathExistsNeighbours, 1);
 
-        visited.push_back(p);
-
-        if (p == std::make_pair(destinationRow, destinationColumn))
+        if (isTilePassable(m_tileMap[nextIndex]) && m_passableRegions.getRegion(nextIndex) == destinationRegion)
             return true;
-
-        for (auto i = 0; i < offsets.size(); i++)
-        {
-            const auto nextRow    = p.first  + offsets[i].first;
-            const auto nextColumn = p.second + offsets[i].second;
-            const auto nextTile   = std::make_pair(nextRow, nextColumn);
-
-            if (nextRow    >= 0 && nextRow    < m_tileMap.size()    &&
-                nextColumn >= 0 && nextColumn < m_tileMap[0].size() &&
-                isTilePassable(m_tileMap[nextRow][nextColumn]) &&
-                std::find(visited.begin(), visited.end(), nextTile) == visited.end())
-            {
-                q.push(nextTile);
-            }
-        }
     }
 
     return false;
@@ -251,8 +824,48 @@ bool GameEngine::pathExists(const int sourceRow,
  * Finds all possible streaks for a ball and deletes them
  * Returns earned amount of points
  */
-int GameEngine::deleteStreaks(const int row, const int column)
+int GameEngine::deleteStreaks(const int index)
 {
+#ifdef COLORLINES_BITBOARD_STREAKS
+
+    // The bitboards give all the lines through the ball at once,
+    // they are deleted together with the ball itself.
+    // A ball alone is not a streak even if the minimal length allows it,
+    // the same as in the tile by tile version below
+
+    COLORLINES_TIME(BitBoardStreaks);
+
+    const auto tile = m_tileMap[index];
+    const auto& streaks = m_ballBitBoards.findStreaksThrough(index, tile);
+
+    const auto totalStreakLength = streaks.count();
+    if (totalStreakLength < 2)
+        return 0;
+
+    logStreak(index, tile, totalStreakLength);
+
+    // The balls are deleted in the same order as the tile by tile version does it:
+    // outward along every direction and the ball itself last,
+    // as the order of the free cells, which the new balls are chosen from, depends on it
+    const auto stride = m_tileMap.getStride();
+    const int steps[] {1, stride, stride + 1, stride - 1};
+
+    for (const auto step : steps)
+    {
+        for (auto i = index - step; streaks.test(i); i -= step)
+            setTile(i, Tile::Empty);
+
+        for (auto i = index + step; streaks.test(i); i += step)
+            setTile(i, Tile::Empty);
+    }
+
+    setTile(index, Tile::Empty);
+
+    COLORLINES_COUNT(BallsDeleted, totalStreakLength);
+    return totalStreakLength;
+
+#else
+
     // We check all possible directions,
     // then we delete only adjacent balls if combinations are found.
     // We delete the selected ball only after we delete balls in all directions
@@ -260,25 +873,43 @@ int GameEngine::deleteStreaks(const int row, const int column)
 
     auto totalStreakLength = 0;
 
-    if (isHorizontalStreak(row, column))
-        totalStreakLength += deleteAdjacentHorizontalStreak(row, column);
+    if (isHorizontalStreak(index))
+        totalStreakLength += deleteAdjacentHorizontalStreak(index);
 
-    if (isVerticalStreak(row, column))
-        totalStreakLength += deleteAdjacentVerticalStreak(row, column);
+    if (isVerticalStreak(index))
+        totalStreakLength += deleteAdjacentVerticalStreak(index);
 
-    if (isMainDiagonalStreak(row, column))
-        totalStreakLength += deleteAdjacentMainDiagonalStreak(row, column);
+    if (isMainDiagonalStreak(index))
+        totalStreakLength += deleteAdjacentMainDiagonalStreak(index);
 
-    if (isAntiDiagonalStreak(row, column))
-        totalStreakLength += deleteAdjacentAntiDiagonalStreak(row, column);
+    if (isAntiDiagonalStreak(index))
+        totalStreakLength += deleteAdjacentAntiDiagonalStreak(index);
 
     if (totalStreakLength == 0)
         return totalStreakLength;
 
-    m_tileMap[row][column] = Tile::Empty;
+    logStreak(index, m_tileMap[index], totalStreakLength + 1);
+
+    setTile(index, Tile::Empty);
     totalStreakLength++;
 
+    COLORLINES_COUNT(BallsDeleted, totalStreakLength);
     return totalStreakLength;
+
+#endif
+}
+
+/*
+ * The color is counted from one, as the player sees it
+ */
+void GameEngine::logStreak(const int index, const Tile tile, const int length) const
+{
+    if (m_logger.pointer != nullptr)
+    {
+        m_logger.pointer->write(LogLevel::Debug, LogEvent::StreakCleared,
+                                {m_tileMap.toRow(index), m_tileMap.toColumn(index), length,
+                                 static_cast <int>(tile - Tile::ColorOne) + 1, 0});
+    }
 }
 
 void GameEngine::increaseScore(const int streakLength)
@@ -287,230 +918,331 @@ void GameEngine::increaseScore(const int streakLength)
     m_score += streakLength * (streakLength - m_minStreakLength + 1);
 }
 
-bool GameEngine::isHorizontalStreak(const int row, const int column) const
+/*
+ * Counts the ball itself and the same balls next to it on both sides along the step
+ * The scan needs no bounds checks: a border tile never equals a ball
+ */
+int GameEngine::getStreakLength(const int index, const int step) const
 {
+    const auto tile = m_tileMap[index];
     auto streakLength = 1;
 
-    for (auto j = column - 1; j >= 0; j--)
-    {
-        if (m_tileMap[row][j] == m_tileMap[row][column])
-            streakLength++;
-        else
-            break;
-    }
+    for (auto i = index - step; m_tileMap[i] == tile; i -= step)
+        streakLength++;
 
-    for (auto j = column + 1; j < m_tileMap[0].size(); j++)
-    {
-        if (m_tileMap[row][j] == m_tileMap[row][column])
-            streakLength++;
-        else
-            break;
-    }
+    for (auto i = index + step; m_tileMap[i] == tile; i += step)
+        streakLength++;
 
-    if (streakLength < m_minStreakLength)
-        return false;
-    return true;
+    return streakLength;
 }
 
-int GameEngine::deleteAdjacentHorizontalStreak(const int row, const int column)
+/*
+ * Deletes the same balls next to the given one on both sides along the step
+ * Returns the number of deleted balls, the given ball itself is kept
+ */
+int GameEngine::deleteAdjacentStreak(const int index, const int step)
 {
+    const auto tile = m_tileMap[index];
     auto streakLength = 0;
 
-    for (auto j = column - 1; j >= 0; j--)
+    for (auto i = index - step; m_tileMap[i] == tile; i -= step)
     {
-        if (m_tileMap[row][j] == m_tileMap[row][column])
-        {
-            m_tileMap[row][j] = Tile::Empty;
-            streakLength++;
-        }
-        else
-            break;
+        setTile(i, Tile::Empty);
+        streakLength++;
     }
 
-    for (auto j = column + 1; j < m_tileMap[0].size(); j++)
+    for (auto i = index + step; m_tileMap[i] == tile; i += step)
     {
-        if (m_tileMap[row][j] == m_tileMap[row][column])
-        {
-            m_tileMap[row][j] = Tile::Empty;
-            streakLength++;
-        }
-        else
-            break;
+        setTile(i, Tile::Empty);
+        streakLength++;
     }
 
     return streakLength;
 }
 
-bool GameEngine::isVerticalStreak(const int row, const int column) const
+bool GameEngine::isHorizontalStreak(const int index) const
 {
-    auto streakLength = 1;
+    COLORLINES_TIME(HorizontalStreak);
+    COLORLINES_COUNT(HorizontalStreakChecks, 1);
+    return getStreakLength(index, 1) >= m_minStreakLength;
+}
 
-    for (auto i = row - 1; i >= 0; i--)
-    {
-        if (m_tileMap[i][column] == m_tileMap[row][column])
-            streakLength++;
-        else
-            break;
-    }
+int GameEngine::deleteAdjacentHorizontalStreak(const int index)
+{
+    COLORLINES_TIME(HorizontalStreak);
+    COLORLINES_COUNT(HorizontalStreaks, 1);
+    return deleteAdjacentStreak(index, 1);
+}
 
-    for (auto i = row + 1; i < m_tileMap.size(); i++)
-    {
-        if (m_tileMap[i][column] == m_tileMap[row][column])
-            streakLength++;
-        else
-            break;
-    }
+bool GameEngine::isVerticalStreak(const int index) const
+{
+    COLORLINES_TIME(VerticalStreak);
+    COLORLINES_COUNT(VerticalStreakChecks, 1);
+    return getStreakLength(index, m_tileMap.getStride()) >= m_minStreakLength;
+}
 
-    if (streakLength < m_minStreakLength)
-        return false;
-    return true;
+int GameEngine::deleteAdjacentVerticalStreak(const int index)
+{
+    COLORLINES_TIME(VerticalStreak);
+    COLORLINES_COUNT(VerticalStreaks, 1);
+    return deleteAdjacentStreak(index, m_tileMap.getStride());
 }
 
-int GameEngine::deleteAdjacentVerticalStreak(const int row, const int column)
+bool GameEngine::isMainDiagonalStreak(const int index) const
 {
-    auto streakLength = 0;
+    COLORLINES_TIME(MainDiagonalStreak);
+    COLORLINES_COUNT(MainDiagonalStreakChecks, 1);
+    return getStreakLength(index, m_tileMap.getStride() + 1) >= m_minStreakLength;
+}
 
-    for (auto i = row - 1; i >= 0; i--)
-    {
-        if (m_tileMap[i][column] == m_tileMap[row][column])
-        {
-            m_tileMap[i][column] = Tile::Empty;
-            streakLength++;
-        }
-        else
-            break;
-    }
+int GameEngine::deleteAdjacentMainDiagonalStreak(const int index)
+{
+    COLORLINES_TIME(MainDiagonalStreak);
+    COLORLINES_COUNT(MainDiagonalStreaks, 1);
+    return deleteAdjacentStreak(index, m_tileMap.getStride() + 1);
+}
 
-    for (auto i = row + 1; i < m_tileMap.size(); i++)
-    {
-        if (m_tileMap[i][column] == m_tileMap[row][column])
-        {
-            m_tileMap[i][column] = Tile::Empty;
-            streakLength++;
-        }
-        else
-            break;
-    }
+bool GameEngine::isAntiDiagonalStreak(const int index) const
+{
+    COLORLINES_TIME(AntiDiagonalStreak);
+    COLORLINES_COUNT(AntiDiagonalStreakChecks, 1);
+    return getStreakLength(index, m_tileMap.getStride() - 1) >= m_minStreakLength;
+}
 
-    return streakLength;
+int GameEngine::deleteAdjacentAntiDiagonalStreak(const int index)
+{
+    COLORLINES_TIME(AntiDiagonalStreak);
+    COLORLINES_COUNT(AntiDiagonalStreaks, 1);
+    return deleteAdjacentStreak(index, m_tileMap.getStride() - 1);
 }
 
-bool GameEngine::isMainDiagonalStreak(const int row, const int column) const
+bool GameEngine::isGameOver() const
 {
-    auto streakLength = 1;
+    return (m_state == GameState::GameOver);
+}
 
-    for (auto i = row - 1, j = column - 1; i >= 0 && j >= 0; i--, j--)
-    {
-        if (m_tileMap[i][j] == m_tileMap[row][column])
-            streakLength++;
-        else
-            break;
-    }
+/*
+ * Checks a move without making it, the same way the second pick does
+ */
+bool GameEngine::isMovePossible(const Move& move) const
+{
+    const auto sourceIndex = m_tileMap.toIndex(move.sourceRow, move.sourceColumn);
+    const auto destinationIndex = m_tileMap.toIndex(move.destinationRow, move.destinationColumn);
 
-    for (auto i = row + 1, j = column + 1; i < m_tileMap.size() && j < m_tileMap[0].size(); i++, j++)
-    {
-        if (m_tileMap[i][j] == m_tileMap[row][column])
-            streakLength++;
-        else
-            break;
-    }
+    return (isBall(m_tileMap[sourceIndex]) &&
+            isTilePassable(m_tileMap[destinationIndex]) &&
+            pathExists(sourceIndex, destinationIndex));
+}
 
-    if (streakLength < m_minStreakLength)
+std::pair <int, int> GameEngine::getSelection() const
+{
+    return m_selection;
+}
+
+/*
+ * Impossible moves are rejected by the regions, so only the moves that have a path are searched
+ * The ball may be selected, as it is between the picks of the player
+ */
+bool GameEngine::findPath(const Move& move, std::vector <std::pair <int, int>>& path) const
+{
+    path.clear();
+
+    const auto sourceIndex = m_tileMap.toIndex(move.sourceRow, move.sourceColumn);
+    const auto destinationIndex = m_tileMap.toIndex(move.destinationRow, move.destinationColumn);
+    const auto sourceTile = m_tileMap[sourceIndex];
+
+    if (!(isBall(sourceTile) || isSelected(sourceTile)) ||
+        !isTilePassable(m_tileMap[destinationIndex]) ||
+        !pathExists(sourceIndex, destinationIndex))
         return false;
+
+    if (!m_pathFinder.find(m_tileMap, sourceIndex, destinationIndex, m_pathCells))
+        return false;
+
+    for (const auto index : m_pathCells)
+        path.emplace_back(m_tileMap.toRow(index), m_tileMap.toColumn(index));
+
     return true;
 }
 
-int GameEngine::deleteAdjacentMainDiagonalStreak(const int row, const int column)
+/*
+ * A ball can move to every cell of the passable regions around it,
+ * so the passable cells are grouped by region once and every ball takes whole groups
+ *
+ * The cells of a group are in increasing order of index, which is the order of rows and columns,
+ * and the groups of one ball are merged, so the moves come in the same order as cell by cell checks give
+ */
+void GameEngine::generateMoves(std::vector <Move>& moves) const
 {
-    auto streakLength = 0;
+    moves.clear();
+
+    if (m_state == GameState::GameOver)
+        return;
 
-    for (auto i = row - 1, j = column - 1; i >= 0 && j >= 0; i--, j--)
+    // A counting sort of the passable cells by their region,
+    // the regions are numbered densely, so the buckets are no more than the passable cells
+
+    const auto cellCount = m_tileMap.getCellCount();
+    const auto regionCount = m_passableRegions.labelRegions(m_tileMap, m_cellRegions);
+    m_regionStarts.assign(regionCount + 1, 0);
+
+    for (auto i = 0; i < cellCount; i++)
     {
-        if (m_tileMap[i][j] == m_tileMap[row][column])
-        {
-            m_tileMap[i][j] = Tile::Empty;
-            streakLength++;
-        }
-        else
-            break;
+        if (m_cellRegions[i] >= 0)
+            m_regionStarts[m_cellRegions[i] + 1]++;
     }
 
-    for (auto i = row + 1, j = column + 1; i < m_tileMap.size() && j < m_tileMap[0].size(); i++, j++)
+    for (auto i = 0; i < regionCount; i++)
+        m_regionStarts[i + 1] += m_regionStarts[i];
+
+    m_regionCells.resize(m_regionStarts[regionCount]);
+
+    for (auto i = 0; i < cellCount; i++)
     {
-        if (m_tileMap[i][j] == m_tileMap[row][column])
-        {
-            m_tileMap[i][j] = Tile::Empty;
-            streakLength++;
-        }
-        else
-            break;
+        if (m_cellRegions[i] >= 0)
+            m_regionCells[m_regionStarts[m_cellRegions[i]]++] = i;
     }
 
-    return streakLength;
-}
+    // Every start has moved to the end of its region, which is the start of the next one
+    for (auto i = regionCount; i > 0; i--)
+        m_regionStarts[i] = m_regionStarts[i - 1];
 
-bool GameEngine::isAntiDiagonalStreak(const int row, const int column) const
-{
-    auto streakLength = 1;
+    m_regionStarts[0] = 0;
 
-    for (auto i = row - 1, j = column + 1; i >= 0 && j < m_tileMap[0].size(); i--, j++)
+    const auto stride = m_tileMap.getStride();
+    const int offsets[] {-stride, -1, stride, 1};
+
+    for (auto sourceIndex = 0; sourceIndex < cellCount; sourceIndex++)
     {
-        if (m_tileMap[i][j] == m_tileMap[row][column])
-            streakLength++;
-        else
-            break;
+        if (!isBall(m_tileMap[sourceIndex]))
+            continue;
+
+        // The cursors and the ends of the regions next to the ball, each region is taken once
+        int cursors[4];
+        int ends[4];
+        auto nearRegionCount = 0;
+
+        for (const auto offset : offsets)
+        {
+            const auto neighbour = sourceIndex + offset;
+
+            const auto region = m_cellRegions[neighbour];
+            if (region < 0)
+                continue;
+
+            if (std::find(cursors, cursors + nearRegionCount, m_regionStarts[region]) != cursors + nearRegionCount)
+                continue;
+
+            cursors[nearRegionCount] = m_regionStarts[region];
+            ends[nearRegionCount] = m_regionStarts[region + 1];
+            nearRegionCount++;
+        }
+
+        const auto sourceRow = m_tileMap.toRow(sourceIndex);
+        const auto sourceColumn = m_tileMap.toColumn(sourceIndex);
+
+        while (nearRegionCount > 0)
+        {
+            // The region with the smallest next cell gives the next destination
+            auto next = 0;
+            for (auto i = 1; i < nearRegionCount; i++)
+            {
+                if (m_regionCells[cursors[i]] < m_regionCells[cursors[next]])
+                    next = i;
+            }
+
+            const auto destinationIndex = m_regionCells[cursors[next]++];
+            moves.push_back(Move {sourceRow, sourceColumn, m_tileMap.toRow(destinationIndex), m_tileMap.toColumn(destinationIndex)});
+
+            if (cursors[next] == ends[next])
+            {
+                nearRegionCount--;
+                cursors[next] = cursors[nearRegionCount];
+                ends[next] = ends[nearRegionCount];
+            }
+        }
     }
+}
 
-    for (auto i = row + 1, j = column - 1; i < m_tileMap.size() && j >= 0; i++, j--)
+bool GameEngine::applyMove(const Move& move)
+{
+    if (m_state == GameState::GameOver)
+        return false;
+
+    if (m_state == GameState::SecondPick)
     {
-        if (m_tileMap[i][j] == m_tileMap[row][column])
-            streakLength++;
-        else
-            break;
+        deselectTile();
+        m_state = GameState::FirstPick;
     }
 
-    if (streakLength < m_minStreakLength)
+    if (!isMovePossible(move))
         return false;
+
+    if (isRecorded())
+        m_replay.pointer->recordMove(move);
+
+    makeMove(m_tileMap.toIndex(move.sourceRow, move.sourceColumn),
+             m_tileMap.toIndex(move.destinationRow, move.destinationColumn));
+
     return true;
 }
 
-int GameEngine::deleteAdjacentAntiDiagonalStreak(const int row, const int column)
+const Board& GameEngine::getTileMap() const
 {
-    auto streakLength = 0;
+    return m_tileMap;
+}
 
-    for (auto i = row - 1, j = column + 1; i >= 0 && j < m_tileMap[0].size(); i--, j++)
-    {
-        if (m_tileMap[i][j] == m_tileMap[row][column])
-        {
-            m_tileMap[i][j] = Tile::Empty;
-            streakLength++;
-        }
-        else
-            break;
-    }
+std::uint64_t GameEngine::getTileMapVersion() const
+{
+    return m_tileMapVersion;
+}
 
-    for (auto i = row + 1, j = column - 1; i < m_tileMap.size() && j >= 0; i++, j--)
-    {
-        if (m_tileMap[i][j] == m_tileMap[row][column])
-        {
-            m_tileMap[i][j] = Tile::Empty;
-            streakLength++;
-        }
-        else
-            break;
-    }
+std::uint64_t GameEngine::getPositionVersion() const
+{
+    return m_positionVersion;
+}
 
-    return streakLength;
+std::uint64_t GameEngine::getHash() const
+{
+    return m_hash;
 }
 
-bool GameEngine::isGameOver() const
+const TileRectangle& GameEngine::getDirtyRegion() const
 {
-    return (m_state == GameState::GameOver);
+    return m_dirtyRegion;
 }
 
-const std::vector <std::vector <Tile>>& GameEngine::getTileMap() const
+const std::vector <int>& GameEngine::getDirtyChunks() const
 {
-    return m_tileMap;
+    return m_dirtyChunks;
+}
+
+int GameEngine::getChunkCountInRow() const
+{
+    return m_chunkCountInRow;
+}
+
+/*
+ * The chunks of the last row and column may be cut by the edges of the tilemap
+ */
+TileRectangle GameEngine::getChunkRectangle(const int chunk) const
+{
+    const auto top = (chunk / m_chunkCountInRow) * m_chunkSizeInTiles;
+    const auto left = (chunk % m_chunkCountInRow) * m_chunkSizeInTiles;
+
+    return TileRectangle {top, left,
+                          std::min(top + m_chunkSizeInTiles, m_tileMap.getHeight()),
+                          std::min(left + m_chunkSizeInTiles, m_tileMap.getWidth())};
+}
+
+void GameEngine::clearDirtyRegion()
+{
+    m_dirtyRegion = TileRectangle {0, 0, 0, 0};
+
+    for (const auto chunk : m_dirtyChunks)
+        m_isChunkDirty[chunk] = false;
+
+    m_dirtyChunks.clear();
 }
 
 int GameEngine::getScore() const
@@ -518,6 +1250,11 @@ int GameEngine::getScore() const
     return m_score;
 }
 
+int GameEngine::getFreeCellCount() const
+{
+    return m_freeCells.getCount();
+}
+
 void GameEngine::increaseTimer()
 {
     m_timeElapsedInSeconds++;
@@ -530,12 +1267,12 @@ int GameEngine::getTimeInSeconds() const
 
 int GameEngine::getTileMapWidth() const
 {
-    return m_tileMap.at(0).size();
+    return m_tileMap.getWidth();
 }
 
 int GameEngine::getTileMapHeight() const
 {
-    return m_tileMap.size();
+    return m_tileMap.getHeight();
 }
 
 int GameEngine::getColorCount() const
@@ -547,3 +1284,22 @@ int GameEngine::getState() const
 {
     return static_cast <int>(m_state);
 }
+
+/*
+ * Snapshots are little-endian on any platform
+ */
+void GameEngine::putInteger(unsigned char* data, const std::uint64_t value, const int byteCount)
+{
+    for (auto i = 0; i < byteCount; i++)
+        data[i] = static_cast <unsigned char>(value >> (8 * i));
+}
+
+std::uint64_t GameEngine::getInteger(const unsigned char* data, const int byteCount)
+{
+    std::uint64_t value = 0;
+
+    for (auto i = 0; i < byteCount; i++)
+        value |= static_cast <std::uint64_t>(data[i]) << (8 * i);
+
+    return value;
+}
@@ -0,0 +1,70 @@
+#include "GreedyMovePolicy.hpp"
+
+GreedyMovePolicy::GreedyMovePolicy()
+{
+    //ctor
+}
+
+GreedyMovePolicy::~GreedyMovePolicy()
+{
+    //dtor
+}
+
+void GreedyMovePolicy::setSeed(const std::uint64_t seed)
+{
+    m_random.setSeed(seed);
+}
+
+bool GreedyMovePolicy::chooseMove(const GameEngine& game, Move& move)
+{
+    game.generateMoves(m_moves);
+
+    auto bestCount = -1;
+    auto tieCount = 0;
+
+    for (const auto& candidate : m_moves)
+    {
+        const auto count = countSameNeighbours(game.getTileMap(), candidate);
+
+        if (count > bestCount)
+        {
+            bestCount = count;
+            tieCount = 1;
+            move = candidate;
+        }
+
+        // Every one of equally good moves replaces the chosen one with probability 1/n,
+        // so all of them are equally likely in the end
+        else if (count == bestCount && m_random.getInteger(0, ++tieCount) == 0)
+        {
+            move = candidate;
+        }
+    }
+
+    return bestCount >= 0;
+}
+
+/*
+ * Counts the balls of the moved color in all eight cells around the destination
+ * The moved ball itself is not counted
+ */
+int GreedyMovePolicy::countSameNeighbours(const Board& tileMap, const Move& move) const
+{
+    const auto stride = tileMap.getStride();
+    const int offsets[] {-stride - 1, -stride, -stride + 1, -1, 1, stride - 1, stride, stride + 1};
+
+    const auto sourceIndex = tileMap.toIndex(move.sourceRow, move.sourceColumn);
+    const auto destinationIndex = tileMap.toIndex(move.destinationRow, move.destinationColumn);
+
+    auto count = 0;
+
+    for (const auto offset : offsets)
+    {
+        const auto index = destinationIndex + offset;
+
+        if (index != sourceIndex && tileMap[index] == tileMap[sourceIndex])
+            count++;
+    }
+
+    return count;
+}
@@ -0,0 +1,205 @@
+#include "Instrumentation.hpp"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <iomanip>
+
+namespace
+{
+    const char* const counterNames[] {
+        "path_exists_calls",
+        "path_exists_neighbours",
+        "path_search_cells",
+        "region_updates",
+        "region_rebuilds",
+        "region_split_checks",
+        "region_search_cells",
+        "region_relabel_cells",
+        "horizontal_streak_checks",
+        "horizontal_streaks",
+        "vertical_streak_checks",
+        "vertical_streaks",
+        "main_diagonal_streak_checks",
+        "main_diagonal_streaks",
+        "anti_diagonal_streak_checks",
+        "anti_diagonal_streaks",
+        "balls_deleted",
+        "expected_balls_added",
+        "random_rejections",
+        "balls_transformed"
+    };
+
+    const char* const timerNames[] {
+        "make_move",
+        "path_exists",
+        "find_path",
+        "region_update",
+        "horizontal_streak",
+        "vertical_streak",
+        "main_diagonal_streak",
+        "anti_diagonal_streak",
+        "bitboard_streaks",
+        "add_expected_balls",
+        "transform_expected_balls"
+    };
+
+    static_assert(std::size(counterNames) == Instrumentation::m_counterCount);
+    static_assert(std::size(timerNames) == Instrumentation::m_timerCount);
+}
+
+/*
+ * The blocks of finished threads are kept, so their counts are still reported
+ * The ticks are compared with the clock since the start of the program to find their rate
+ */
+struct Instrumentation::Registry
+{
+    std::mutex mutex;
+    std::vector <std::unique_ptr <Block>> blocks;
+    std::uint64_t startTicks = getTicks();
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+};
+
+Instrumentation::Registry& Instrumentation::getRegistry()
+{
+    static Registry registry;
+    return registry;
+}
+
+Instrumentation::Block& Instrumentation::getBlock()
+{
+    thread_local Block* block = nullptr;
+
+    if (block == nullptr)
+    {
+        auto& registry = getRegistry();
+        std::lock_guard <std::mutex> lock(registry.mutex);
+
+        registry.blocks.push_back(std::make_unique <Block>());
+        block = registry.blocks.back().get();
+    }
+
+    return *block;
+}
+
+Instrumentation::Report Instrumentation::collect()
+{
+    auto& registry = getRegistry();
+    std::lock_guard <std::mutex> lock(registry.mutex);
+
+    Report report {isEnabled(), static_cast <int>(registry.blocks.size()), 0.0, {}, {}, {}};
+
+    for (const auto& block : registry.blocks)
+    {
+        for (auto i = 0; i < m_counterCount; i++)
+            report.counters[i] += block->counters[i].load(std::memory_order_relaxed);
+
+        for (auto i = 0; i < m_timerCount; i++)
+        {
+            report.timerCalls[i] += block->timerCalls[i].load(std::memory_order_relaxed);
+            report.timerTicks[i] += block->timerTicks[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    const std::chrono::duration <double> elapsed = std::chrono::steady_clock::now() - registry.startTime;
+    if (elapsed.count() > 0.0)
+        report.ticksPerSecond = static_cast <double>(getTicks() - registry.startTicks) / elapsed.count();
+
+    return report;
+}
+
+/*
+ * A thread counting meanwhile may keep a part of its counts
+ */
+void Instrumentation::reset()
+{
+    auto& registry = getRegistry();
+    std::lock_guard <std::mutex> lock(registry.mutex);
+
+    for (const auto& block : registry.blocks)
+    {
+        for (auto& counter : block->counters)
+            counter.store(0, std::memory_order_relaxed);
+
+        for (auto i = 0; i < m_timerCount; i++)
+        {
+            block->timerCalls[i].store(0, std::memory_order_relaxed);
+            block->timerTicks[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::string Instrumentation::toJson(const Report& report)
+{
+    std::ostringstream json;
+    json << std::setprecision(9)
+         << "{\n"
+         << "  \"enabled\": " << (report.isEnabled ? "true" : "false") << ",\n"
+         << "  \"threads\": " << report.threadCount << ",\n"
+         << "  \"ticks_per_second\": " << report.ticksPerSecond << ",\n"
+         << "  \"counters\": {";
+
+    for (auto i = 0; i < m_counterCount; i++)
+        json << (i == 0 ? "\n" : ",\n") << "    \"" << counterNames[i] << "\": " << report.counters[i];
+
+    json << "\n  },\n"
+         << "  \"timers\": {";
+
+    for (auto i = 0; i < m_timerCount; i++)
+    {
+        const auto seconds = (report.ticksPerSecond > 0.0) ? report.timerTicks[i] / report.ticksPerSecond : 0.0;
+
+        json << (i == 0 ? "\n" : ",\n") << "    \"" << timerNames[i] << "\": {"
+             << "\"calls\": " << report.timerCalls[i] << ", "
+             << "\"ticks\": " << report.timerTicks[i] << ", "
+             << "\"seconds\": " << seconds << '}';
+    }
+
+    json << "\n  }\n"
+         << "}\n";
+
+    return json.str();
+}
+
+/*
+ * The text exposition format, every value is a counter that only grows
+ */
+std::string Instrumentation::toPrometheus(const Report& report)
+{
+    std::ostringstream text;
+    text << std::setprecision(9);
+
+    text << "# HELP colorlines_engine_events_total Events counted in the engine.\n"
+         << "# TYPE colorlines_engine_events_total counter\n";
+
+    for (auto i = 0; i < m_counterCount; i++)
+        text << "colorlines_engine_events_total{event=\"" << counterNames[i] << "\"} " << report.counters[i] << '\n';
+
+    text << "# HELP colorlines_engine_step_calls_total Timed calls of the steps of the engine.\n"
+         << "# TYPE colorlines_engine_step_calls_total counter\n";
+
+    for (auto i = 0; i < m_timerCount; i++)
+        text << "colorlines_engine_step_calls_total{step=\"" << timerNames[i] << "\"} " << report.timerCalls[i] << '\n';
+
+    text << "# HELP colorlines_engine_step_seconds_total Time spent in the steps of the engine.\n"
+         << "# TYPE colorlines_engine_step_seconds_total counter\n";
+
+    for (auto i = 0; i < m_timerCount; i++)
+    {
+        const auto seconds = (report.ticksPerSecond > 0.0) ? report.timerTicks[i] / report.ticksPerSecond : 0.0;
+        text << "colorlines_engine_step_seconds_total{step=\"" << timerNames[i] << "\"} " << seconds << '\n';
+    }
+
+    return text.str();
+}
+
+const char* Instrumentation::getName(const EngineCounter counter)
+{
+    return counterNames[static_cast <int>(counter)];
+}
+
+const char* Instrumentation::getName(const EngineTimer timer)
+{
+    return timerNames[static_cast <int>(timer)];
+}
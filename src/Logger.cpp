@@ -1,18 +1,93 @@
 #include "Logger.hpp"
+#include "MappedFile.hpp"
 
-Logger::Logger()
+#include <fstream>
+#include <filesystem>
+#include <iomanip>
+
+namespace
+{
+    // "CLLG" read as a little-endian number
+    constexpr std::uint64_t logSignature = 0x474C4C43;
+
+    // The writer gathers up to this many bytes of records before writing them
+    constexpr std::size_t maxBatchSize = 1 << 16;
+
+    // The writer sleeps when the ring is empty, so idle logging costs nothing
+    constexpr auto idleDelay = std::chrono::milliseconds(10);
+
+    constexpr const char* levelNames[] {"debug", "info", "warning", "error"};
+
+    constexpr const char* eventNames[]
+    {
+        "game-started",
+        "move",
+        "spawn",
+        "streak-cleared",
+        "game-over",
+        "frame-stall",
+        "error",
+        "autosave-failed"
+    };
+
+    constexpr std::array <const char*, 5> fieldNames[]
+    {
+        {"width", "height", "colors", "seed-low", "seed-high"},
+        {"source-row", "source-column", "destination-row", "destination-column", "score"},
+        {"balls-added", "free-cells", nullptr, nullptr, nullptr},
+        {"row", "column", "length", "color", nullptr},
+        {"score", "time", "moves", nullptr, nullptr},
+        {"microseconds", "draw-calls", nullptr, nullptr, nullptr},
+        {"state", "score", "time", nullptr, nullptr},
+        {nullptr, nullptr, nullptr, nullptr, nullptr}
+    };
+
+    std::atomic <std::uint16_t> threadCount {0};
+}
+
+Logger::Logger(const std::string& path, const LogLevel level, const std::uint64_t maxFileSize, const int keptFileCount) :
+    m_slots(new Slot[m_capacity]),
+    m_tail(0),
+    m_head(0),
+    m_droppedCount(0),
+    m_level(level),
+    m_isRunning(true),
+    m_startTime(std::chrono::steady_clock::now()),
+    m_startWallTime(std::chrono::duration_cast <std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count()),
+    m_path(path),
+    m_maxFileSize(maxFileSize),
+    m_keptFileCount(keptFileCount),
+    m_file(nullptr, &std::fclose),
+    m_fileSize(0)
 {
-    //ctor
+    for (std::uint64_t i = 0; i < m_capacity; i++)
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+
+    m_batch.reserve(maxBatchSize);
+
+    rotate();
+    if (m_file == nullptr)
+        throw std::runtime_error("Cannot create file " + path);
+
+    m_thread = std::thread(&Logger::run, this);
 }
 
 Logger::~Logger()
 {
-    //dtor
+    m_isRunning.store(false, std::memory_order_release);
+    m_thread.join();
+}
+
+void Logger::setLevel(const LogLevel level)
+{
+    m_level.store(level, std::memory_order_relaxed);
 }
 
 void Logger::writeError(const GameEngine& game, const std::exception& exception)
 {
-    std::ofstream logFile("error.log");
+    write(LogLevel::Error, LogEvent::Error, {game.getState(), game.getScore(), game.getTimeInSeconds(), 0, 0});
+
+    std::ofstream logFile(std::filesystem::path(m_path).replace_filename("error.log"));
     if (!logFile)
         return;
 
@@ -24,10 +99,204 @@ void Logger::writeError(const GameEngine& game, const std::exception& exception)
             << "Game map:\n";
 
     const auto& map = game.getTileMap();
-    for (const auto& row : map)
+    for (auto row = 0; row < map.getHeight(); row++)
     {
-        for (const auto& tile : row)
+        for (const auto& tile : map.getRow(row))
             logFile << std::setfill(' ') << std::setw(2) << std::right << static_cast <int>(tile) << ' ';
         logFile << '\n';
     }
 }
+
+std::uint64_t Logger::getDroppedCount() const
+{
+    return m_droppedCount.load(std::memory_order_relaxed);
+}
+
+/*
+ * Only the writer thread reads, so the head needs no atomics
+ * A slot is given back to the producers for the record one lap later
+ */
+bool Logger::read(LogRecord& record)
+{
+    auto& slot = m_slots[m_head % m_capacity];
+
+    if (slot.sequence.load(std::memory_order_acquire) != m_head + 1)
+        return false;
+
+    record = slot.record;
+    slot.sequence.store(m_head + m_capacity, std::memory_order_release);
+    m_head++;
+
+    return true;
+}
+
+/*
+ * The flag is read before the ring is emptied,
+ * so the writer stops only after it has taken every record written before the stop
+ */
+void Logger::run()
+{
+    while (true)
+    {
+        const auto isRunning = m_isRunning.load(std::memory_order_acquire);
+
+        LogRecord record;
+        while (m_batch.size() < maxBatchSize && read(record))
+        {
+            const auto offset = m_batch.size();
+            m_batch.resize(offset + m_recordSize);
+
+            auto data = m_batch.data() + offset;
+            putInteger(data, static_cast <std::uint64_t>(record.time), 8);
+            putInteger(data + 8, static_cast <std::uint64_t>(record.event), 1);
+            putInteger(data + 9, static_cast <std::uint64_t>(record.level), 1);
+            putInteger(data + 10, record.thread, 2);
+
+            for (auto i = 0; i < 5; i++)
+                putInteger(data + 12 + 4 * i, static_cast <std::uint32_t>(record.values[i]), 4);
+        }
+
+        if (!m_batch.empty())
+            writeBatch();
+        else if (isRunning)
+            std::this_thread::sleep_for(idleDelay);
+        else
+            break;
+    }
+}
+
+/*
+ * There is nobody to report a failed write to, so its records are counted as dropped
+ */
+void Logger::writeBatch()
+{
+    if (m_fileSize + m_batch.size() > m_maxFileSize && m_fileSize > m_headerSize)
+        rotate();
+
+    if (m_file == nullptr ||
+        std::fwrite(m_batch.data(), 1, m_batch.size(), m_file.get()) != m_batch.size() ||
+        std::fflush(m_file.get()) != 0)
+    {
+        m_droppedCount.fetch_add(m_batch.size() / m_recordSize, std::memory_order_relaxed);
+    }
+
+    m_fileSize += m_batch.size();
+    m_batch.clear();
+}
+
+/*
+ * Closes the current file, moves the old ones one number up and starts a new file
+ */
+void Logger::rotate()
+{
+    m_file.reset();
+
+    for (auto i = m_keptFileCount; i > 0; i--)
+    {
+        const auto older = m_path + '.' + std::to_string(i);
+        std::remove(older.c_str());
+
+        const auto newer = (i > 1) ? m_path + '.' + std::to_string(i - 1) : m_path;
+        std::rename(newer.c_str(), older.c_str());
+    }
+
+    std::remove(m_path.c_str());
+    m_file.reset(std::fopen(m_path.c_str(), "wb"));
+    m_fileSize = 0;
+
+    if (m_file == nullptr)
+        return;
+
+    unsigned char header[m_headerSize];
+    putInteger(header, logSignature, 4);
+    putInteger(header + 4, m_version, 4);
+    putInteger(header + 8, m_recordSize, 8);
+    putInteger(header + 16, static_cast <std::uint64_t>(m_startWallTime), 8);
+
+    if (std::fwrite(header, 1, m_headerSize, m_file.get()) != m_headerSize || std::fflush(m_file.get()) != 0)
+        m_file.reset();
+
+    m_fileSize = m_headerSize;
+}
+
+std::vector <LogRecord> Logger::readFile(const std::string& path, std::int64_t& startWallTime)
+{
+    MappedFile file(path);
+
+    const auto data = file.getData();
+    const auto size = file.getSize();
+
+    if (size < m_headerSize || getInteger(data, 4) != logSignature || getInteger(data + 4, 4) != m_version ||
+        getInteger(data + 8, 8) != m_recordSize)
+    {
+        throw std::runtime_error("Not a log file " + path);
+    }
+
+    startWallTime = static_cast <std::int64_t>(getInteger(data + 16, 8));
+
+    // A record cut by a crash is ignored
+    std::vector <LogRecord> records((size - m_headerSize) / m_recordSize);
+
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        const auto record = data + m_headerSize + i * m_recordSize;
+        const auto event = getInteger(record + 8, 1);
+        const auto level = getInteger(record + 9, 1);
+
+        if (event >= static_cast <std::uint64_t>(LogEvent::Count) || level >= static_cast <std::uint64_t>(LogLevel::Count))
+            throw std::runtime_error("Damaged log file " + path);
+
+        records[i].time = static_cast <std::int64_t>(getInteger(record, 8));
+        records[i].event = static_cast <LogEvent>(event);
+        records[i].level = static_cast <LogLevel>(level);
+        records[i].thread = static_cast <std::uint16_t>(getInteger(record + 10, 2));
+
+        for (auto j = 0; j < 5; j++)
+            records[i].values[j] = static_cast <std::int32_t>(getInteger(record + 12 + 4 * j, 4));
+    }
+
+    return records;
+}
+
+const char* Logger::getName(const LogLevel level)
+{
+    return levelNames[static_cast <int>(level)];
+}
+
+const char* Logger::getName(const LogEvent event)
+{
+    return eventNames[static_cast <int>(event)];
+}
+
+const std::array <const char*, 5>& Logger::getFieldNames(const LogEvent event)
+{
+    return fieldNames[static_cast <int>(event)];
+}
+
+/*
+ * Threads are numbered in the order they first write
+ */
+std::uint16_t Logger::getThreadIndex()
+{
+    thread_local const std::uint16_t index = threadCount.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+/*
+ * The file is little-endian on any platform
+ */
+void Logger::putInteger(unsigned char* data, const std::uint64_t value, const int byteCount)
+{
+    for (auto i = 0; i < byteCount; i++)
+        data[i] = static_cast <unsigned char>(value >> (8 * i));
+}
+
+std::uint64_t Logger::getInteger(const unsigned char* data, const int byteCount)
+{
+    std::uint64_t value = 0;
+
+    for (auto i = 0; i < byteCount; i++)
+        value |= static_cast <std::uint64_t>(data[i]) << (8 * i);
+
+    return value;
+}
@@ -0,0 +1,103 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) : m_data(nullptr), m_size(0), m_file(nullptr), m_mapping(nullptr)
+{
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Cannot open file " + path);
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size))
+    {
+        CloseHandle(m_file);
+        throw std::runtime_error("Cannot read file " + path);
+    }
+
+    m_size = static_cast <size_t>(size.QuadPart);
+    if (m_size == 0)
+        return;
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping != nullptr)
+        m_data = static_cast <const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (m_data == nullptr)
+    {
+        if (m_mapping != nullptr)
+            CloseHandle(m_mapping);
+
+        CloseHandle(m_file);
+        throw std::runtime_error("Cannot map file " + path);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+        CloseHandle(m_mapping);
+    }
+
+    CloseHandle(m_file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) : m_data(nullptr), m_size(0), m_descriptor(open(path.c_str(), O_RDONLY))
+{
+    if (m_descriptor < 0)
+        throw std::runtime_error("Cannot open file " + path);
+
+    struct stat status;
+    if (fstat(m_descriptor, &status) != 0)
+    {
+        close(m_descriptor);
+        throw std::runtime_error("Cannot read file " + path);
+    }
+
+    m_size = static_cast <size_t>(status.st_size);
+    if (m_size == 0)
+        return;
+
+    auto data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_descriptor, 0);
+    if (data == MAP_FAILED)
+    {
+        close(m_descriptor);
+        throw std::runtime_error("Cannot map file " + path);
+    }
+
+    m_data = static_cast <const unsigned char*>(data);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+        munmap(const_cast <unsigned char*>(m_data), m_size);
+
+    close(m_descriptor);
+}
+
+#endif
+
+const unsigned char* MappedFile::getData() const
+{
+    return m_data;
+}
+
+size_t MappedFile::getSize() const
+{
+    return m_size;
+}
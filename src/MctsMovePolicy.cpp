@@ -0,0 +1,491 @@
+#include "MctsMovePolicy.hpp"
+
+#include <thread>
+#include <cmath>
+
+namespace
+{
+    // Inner nodes get only the best rated moves, the root gets all of them
+    const int childLimit = 16;
+
+    // A greedy playout move is the best rated of several random ones
+    const int greedyCandidateCount = 8;
+    const int randomMoveAttempts = 64;
+
+    const double freeCellReward = 0.1;
+
+    const int playoutsBetweenTimeChecks = 16;
+    const std::int64_t defaultPlayoutBudget = 2000;
+}
+
+MctsMovePolicy::MctsMovePolicy() :
+    m_seed(0),
+    m_timeBudget(0),
+    m_playoutBudget(defaultPlayoutBudget),
+    m_threadCount(1),
+    m_treeCount(1),
+    m_nodeLimit(1 << 18),
+    m_playoutLength(20),
+    m_isGreedyPlayout(true),
+    m_explorationFactor(1.0f),
+    m_playoutCount(0),
+    m_isStopped(false)
+{
+    //ctor
+}
+
+MctsMovePolicy::~MctsMovePolicy()
+{
+    //dtor
+}
+
+void MctsMovePolicy::setSeed(const std::uint64_t seed)
+{
+    m_seed = seed;
+}
+
+void MctsMovePolicy::setTimeBudget(const std::chrono::milliseconds timeBudget)
+{
+    m_timeBudget = timeBudget;
+}
+
+void MctsMovePolicy::setPlayoutBudget(const std::int64_t playoutBudget)
+{
+    m_playoutBudget = std::max <std::int64_t>(0, playoutBudget);
+}
+
+void MctsMovePolicy::setThreadCount(const int threadCount)
+{
+    m_threadCount = std::max(1, threadCount);
+}
+
+void MctsMovePolicy::setTreeCount(const int treeCount)
+{
+    m_treeCount = std::max(1, treeCount);
+    m_trees.clear();
+}
+
+void MctsMovePolicy::setNodeLimit(const int nodeLimit)
+{
+    m_nodeLimit = std::max(1, nodeLimit);
+    m_trees.clear();
+}
+
+void MctsMovePolicy::setPlayoutLength(const int playoutLength)
+{
+    m_playoutLength = std::max(0, playoutLength);
+}
+
+void MctsMovePolicy::setGreedyPlayouts(const bool isGreedyPlayout)
+{
+    m_isGreedyPlayout = isGreedyPlayout;
+}
+
+void MctsMovePolicy::setExplorationFactor(const float explorationFactor)
+{
+    m_explorationFactor = explorationFactor;
+}
+
+bool MctsMovePolicy::chooseMove(const GameEngine& game, Move& move)
+{
+    MctsResult result;
+
+    if (!search(game, result))
+        return false;
+
+    move = result.bestMove;
+    return true;
+}
+
+bool MctsMovePolicy::search(const GameEngine& game, MctsResult& result)
+{
+    if (game.isGameOver())
+        return false;
+
+    prepareTrees();
+
+    // Without any budget the search would never stop
+    const auto savedPlayoutBudget = m_playoutBudget;
+    if (m_playoutBudget == 0 && m_timeBudget.count() == 0)
+        m_playoutBudget = defaultPlayoutBudget;
+
+    m_playoutCount.store(0);
+    m_isStopped.store(false);
+    m_deadline = std::chrono::steady_clock::now() + m_timeBudget;
+
+    std::vector <Move> moves;
+    std::vector <std::pair <int, int>> ratings;
+
+    for (auto& tree : m_trees)
+    {
+        tree->nodeCount.store(1);
+        initializeNode(tree->nodes[0], Move {0, 0, 0, 0});
+        tree->nodes[0].visitCount.store(1);
+        expandNode(*tree, tree->nodes[0], game, moves, ratings);
+    }
+
+    const auto& firstRoot = m_trees.front()->nodes[0];
+    if (firstRoot.state.load() != Expanded)
+    {
+        m_playoutBudget = savedPlayoutBudget;
+        return false;
+    }
+
+    // One thread searches right here, so policies played on many threads do not start more of them
+    if (m_threadCount == 1)
+    {
+        work(game, 0);
+    }
+    else
+    {
+        std::vector <std::exception_ptr> errors(m_threadCount);
+        std::vector <std::thread> threads;
+
+        for (auto i = 0; i < m_threadCount; i++)
+        {
+            threads.emplace_back([this, i, &game, &errors]()
+            {
+                try
+                {
+                    work(game, i);
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                    m_isStopped.store(true);
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        for (const auto& error : errors)
+        {
+            if (error)
+            {
+                m_playoutBudget = savedPlayoutBudget;
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    m_playoutBudget = savedPlayoutBudget;
+
+    // Every tree has the same root moves in the same order, so their children are summed by position
+    const auto childCount = firstRoot.childCount;
+    auto bestChild = 0;
+    std::int64_t bestVisitCount = -1;
+    auto bestReward = 0.0;
+
+    result.playoutCount = 0;
+    result.nodeCount = 0;
+
+    for (const auto& tree : m_trees)
+    {
+        result.playoutCount += tree->nodes[0].visitCount.load() - 1;
+        result.nodeCount += tree->nodeCount.load();
+    }
+
+    for (auto i = 0; i < childCount; i++)
+    {
+        std::int64_t visitCount = 0;
+        auto reward = 0.0;
+
+        for (const auto& tree : m_trees)
+        {
+            const auto& child = tree->nodes[tree->nodes[0].firstChild + i];
+            visitCount += child.visitCount.load();
+            reward += child.totalReward.load();
+        }
+
+        if (visitCount > bestVisitCount)
+        {
+            bestChild = i;
+            bestVisitCount = visitCount;
+            bestReward = reward;
+        }
+    }
+
+    result.bestMove = m_trees.front()->nodes[firstRoot.firstChild + bestChild].move;
+    result.value = (bestVisitCount > 0) ? static_cast <float>(bestReward / bestVisitCount) : 0.0f;
+
+    // The principal variation follows the most visited children of the first tree
+    const auto& nodes = m_trees.front()->nodes;
+    result.principalVariation.assign(1, result.bestMove);
+
+    for (const Node* node = &nodes[firstRoot.firstChild + bestChild]; node->state.load() == Expanded; )
+    {
+        const Node* next = nullptr;
+
+        for (auto i = node->firstChild; i < node->firstChild + node->childCount; i++)
+        {
+            if (nodes[i].visitCount.load() > 0 && (!next || nodes[i].visitCount.load() > next->visitCount.load()))
+                next = &nodes[i];
+        }
+
+        if (!next)
+            break;
+
+        result.principalVariation.push_back(next->move);
+        node = next;
+    }
+
+    return true;
+}
+
+void MctsMovePolicy::prepareTrees()
+{
+    if (static_cast <int>(m_trees.size()) == m_treeCount)
+        return;
+
+    m_trees.clear();
+
+    for (auto i = 0; i < m_treeCount; i++)
+    {
+        m_trees.push_back(std::make_unique <Tree>());
+        m_trees.back()->nodes = std::make_unique <Node[]>(m_nodeLimit);
+    }
+}
+
+void MctsMovePolicy::initializeNode(Node& node, const Move& move)
+{
+    node.move = move;
+    node.visitCount.store(0, std::memory_order_relaxed);
+    node.virtualLossCount.store(0, std::memory_order_relaxed);
+    node.totalReward.store(0.0, std::memory_order_relaxed);
+    node.firstChild = 0;
+    node.childCount = 0;
+    node.state.store(Unexpanded, std::memory_order_relaxed);
+}
+
+/*
+ * Adds the children of the node in the order of their ratings
+ * Only the thread that marks the node as expanding adds them, the others get false
+ * A node gets no children if they do not fit in the tree, it stays a leaf then
+ */
+bool MctsMovePolicy::expandNode(Tree& tree, Node& node, const GameEngine& game,
+                                std::vector <Move>& moves, std::vector <std::pair <int, int>>& ratings)
+{
+    auto state = static_cast <int>(Unexpanded);
+
+    if (!node.state.compare_exchange_strong(state, Expanding, std::memory_order_acquire))
+        return state == Expanded;
+
+    game.generateMoves(moves);
+
+    ratings.clear();
+    for (auto i = 0; i < static_cast <int>(moves.size()); i++)
+        ratings.emplace_back(rateMove(game.getTileMap(), moves[i]), i);
+
+    const auto isRoot = (&node == &tree.nodes[0]);
+    const auto count = isRoot ? static_cast <int>(ratings.size()) : std::min(childLimit, static_cast <int>(ratings.size()));
+
+    // Equal ratings keep the order of the moves, so the trees of all threads get the same root moves
+    std::partial_sort(ratings.begin(), ratings.begin() + count, ratings.end(),
+                      [](const auto& first, const auto& second)
+                      {
+                          return (first.first > second.first) || (first.first == second.first && first.second < second.second);
+                      });
+
+    const auto firstChild = (count > 0) ? tree.nodeCount.fetch_add(count, std::memory_order_relaxed) : 0;
+
+    if (count == 0 || firstChild + count > m_nodeLimit)
+    {
+        node.state.store(Full, std::memory_order_release);
+        return false;
+    }
+
+    for (auto i = 0; i < count; i++)
+        initializeNode(tree.nodes[firstChild + i], moves[ratings[i].second]);
+
+    node.firstChild = firstChild;
+    node.childCount = count;
+    node.state.store(Expanded, std::memory_order_release);
+
+    return true;
+}
+
+/*
+ * UCT over the children possible in the position, virtual losses count as visits without reward
+ * Unvisited children go first in the order of their ratings
+ * Returns -1 if no child is possible
+ */
+int MctsMovePolicy::selectChild(const Tree& tree, const Node& node, const GameEngine& game, const double rewardScale) const
+{
+    const auto isRoot = (&node == &tree.nodes[0]);
+
+    const auto parentCount = node.visitCount.load(std::memory_order_relaxed) + node.virtualLossCount.load(std::memory_order_relaxed);
+    const auto logParentCount = std::log(static_cast <double>(std::max(1, parentCount)));
+    const auto exploration = m_explorationFactor * rewardScale;
+
+    auto bestChild = -1;
+    auto bestScore = 0.0;
+
+    for (auto i = node.firstChild; i < node.firstChild + node.childCount; i++)
+    {
+        const auto& child = tree.nodes[i];
+
+        // The root moves are made in the root position, so they are always possible
+        if (!isRoot && !game.isMovePossible(child.move))
+            continue;
+
+        const auto count = child.visitCount.load(std::memory_order_relaxed) + child.virtualLossCount.load(std::memory_order_relaxed);
+
+        if (count == 0)
+            return i;
+
+        const auto score = child.totalReward.load(std::memory_order_relaxed) / count +
+                           exploration * std::sqrt(logParentCount / count);
+
+        if (bestChild == -1 || score > bestScore)
+        {
+            bestChild = i;
+            bestScore = score;
+        }
+    }
+
+    return bestChild;
+}
+
+/*
+ * Every playout is numbered, and its balls and moves are drawn from its number only
+ * The engine goes back to the root position by taking back all the moves of the playout
+ */
+void MctsMovePolicy::work(const GameEngine& rootGame, const int threadIndex)
+{
+    auto& tree = *m_trees[threadIndex % m_treeCount];
+
+    GameEngine game;
+    game.copyPosition(rootGame);
+    game.setRandomAlgorithm(RandomNumberGenerator::Algorithm::Xoshiro256StarStar);
+
+    RandomNumberGenerator random;
+    std::vector <Move> moves;
+    std::vector <std::pair <int, int>> ratings;
+    std::vector <Node*> path;
+
+    auto& root = tree.nodes[0];
+    const auto rootScore = game.getScore();
+
+    while (!m_isStopped.load(std::memory_order_relaxed))
+    {
+        const auto playout = m_playoutCount.fetch_add(1, std::memory_order_relaxed);
+
+        if (m_playoutBudget > 0 && playout >= m_playoutBudget)
+            break;
+
+        if (m_timeBudget.count() > 0 && playout % playoutsBetweenTimeChecks == 0 &&
+            std::chrono::steady_clock::now() >= m_deadline)
+        {
+            m_isStopped.store(true, std::memory_order_relaxed);
+            break;
+        }
+
+        game.setRandomSeed(RandomNumberGenerator::mixSeed(m_seed, 2 * playout));
+        random.setSeed(RandomNumberGenerator::mixSeed(m_seed, 2 * playout + 1));
+
+        const auto rootCount = root.visitCount.load(std::memory_order_relaxed);
+        const auto rewardScale = std::max(1.0, root.totalReward.load(std::memory_order_relaxed) / std::max(1, rootCount));
+
+        // Down the tree
+        auto node = &root;
+        path.assign(1, node);
+        auto moveCount = 0;
+
+        while (!game.isGameOver())
+        {
+            auto isExpanded = (node->state.load(std::memory_order_acquire) == Expanded);
+
+            if (!isExpanded && node->visitCount.load(std::memory_order_relaxed) > 0)
+                isExpanded = expandNode(tree, *node, game, moves, ratings);
+
+            if (!isExpanded)
+                break;
+
+            const auto child = selectChild(tree, *node, game, rewardScale);
+            if (child == -1)
+                break;
+
+            node = &tree.nodes[child];
+            node->virtualLossCount.fetch_add(1, std::memory_order_relaxed);
+            path.push_back(node);
+
+            game.applyMove(node->move);
+            moveCount++;
+        }
+
+        // Out of the tree
+        for (auto i = 0; i < m_playoutLength && !game.isGameOver(); i++)
+        {
+            Move move;
+            if (!chooseRandomMove(game, random, moves, move))
+                break;
+
+            game.applyMove(move);
+            moveCount++;
+        }
+
+        auto reward = static_cast <double>(game.getScore() - rootScore);
+        if (!game.isGameOver())
+            reward += freeCellReward * game.getFreeCellCount();
+
+        for (auto pathNode : path)
+        {
+            pathNode->visitCount.fetch_add(1, std::memory_order_relaxed);
+            pathNode->totalReward.fetch_add(reward, std::memory_order_relaxed);
+
+            if (pathNode != &root)
+                pathNode->virtualLossCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        for (auto i = 0; i < moveCount; i++)
+            game.undo();
+    }
+}
+
+/*
+ * Tries random pairs of a ball and a cell, which is much faster than listing all the moves
+ * and is needed only when the board is nearly full
+ * A greedy playout takes the best rated of several possible moves
+ */
+bool MctsMovePolicy::chooseRandomMove(const GameEngine& game, RandomNumberGenerator& random,
+                                      std::vector <Move>& moves, Move& move) const
+{
+    const auto& tileMap = game.getTileMap();
+    const auto width = tileMap.getWidth();
+    const auto height = tileMap.getHeight();
+
+    const auto candidateCount = m_isGreedyPlayout ? greedyCandidateCount : 1;
+    auto foundCount = 0;
+    auto bestRating = -1;
+
+    for (auto attempt = 0; attempt < randomMoveAttempts && foundCount < candidateCount; attempt++)
+    {
+        const Move candidate {random.getInteger(0, height), random.getInteger(0, width),
+                              random.getInteger(0, height), random.getInteger(0, width)};
+
+        if (!isBall(tileMap.get(candidate.sourceRow, candidate.sourceColumn)) || !game.isMovePossible(candidate))
+            continue;
+
+        foundCount++;
+
+        const auto rating = m_isGreedyPlayout ? rateMove(tileMap, candidate) : 0;
+        if (rating > bestRating)
+        {
+            bestRating = rating;
+            move = candidate;
+        }
+    }
+
+    if (foundCount > 0)
+        return true;
+
+    game.generateMoves(moves);
+
+    if (moves.empty())
+        return false;
+
+    move = moves[random.getInteger(0, static_cast <int>(moves.size()))];
+    return true;
+}
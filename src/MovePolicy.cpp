@@ -0,0 +1,48 @@
+#include "MovePolicy.hpp"
+
+MovePolicy::MovePolicy()
+{
+    //ctor
+}
+
+MovePolicy::~MovePolicy()
+{
+    //dtor
+}
+
+void MovePolicy::setSeed(const std::uint64_t)
+{
+    // Deterministic policies have nothing to seed
+}
+
+/*
+ * Rates a move without making it: the longer the lines of the moved color through the destination,
+ * the better, and a line grows as the square of its length
+ * The source cell does not count, the ball leaves it
+ */
+int MovePolicy::rateMove(const Board& tileMap, const Move& move)
+{
+    const auto stride = tileMap.getStride();
+    const int steps[] {1, stride, stride + 1, stride - 1};
+
+    const auto sourceIndex = tileMap.toIndex(move.sourceRow, move.sourceColumn);
+    const auto destinationIndex = tileMap.toIndex(move.destinationRow, move.destinationColumn);
+    const auto tile = tileMap[sourceIndex];
+
+    auto rating = 0;
+
+    for (const auto step : steps)
+    {
+        auto length = 1;
+
+        for (auto i = destinationIndex - step; i != sourceIndex && tileMap[i] == tile; i -= step)
+            length++;
+
+        for (auto i = destinationIndex + step; i != sourceIndex && tileMap[i] == tile; i += step)
+            length++;
+
+        rating += length * length;
+    }
+
+    return rating;
+}
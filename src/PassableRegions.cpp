@@ -0,0 +1,412 @@
+#include "PassableRegions.hpp"
+#include "Instrumentation.hpp"
+
+#include <limits>
+
+namespace
+{
+    // Cells change passability on every move and on every undo, so the forest has room for several
+    // changes of every cell before it is rebuilt
+    const int nodeCountPerCell = 8;
+
+    // Huge tilemaps get fewer spare nodes, which only makes the rare rebuilds a bit more frequent
+    const int maxSpareNodeCount = 1 << 22;
+}
+
+PassableRegions::PassableRegions() : m_nextNode(0), m_currentMark(0), m_currentRootMark(0), m_offsets{0, 0, 0, 0}, m_ringOffsets{0, 0, 0, 0, 0, 0, 0, 0}
+{
+    //ctor
+}
+
+PassableRegions::~PassableRegions()
+{
+    //dtor
+}
+
+/*
+ * Labels the whole tilemap from scratch
+ * Every cell starts with the node of its own index, and the nodes after them are left for new ones
+ */
+void PassableRegions::rebuild(const Board& board)
+{
+    COLORLINES_COUNT(RegionRebuilds, 1);
+
+    const auto stride = board.getStride();
+    const auto cellCount = board.getCellCount();
+
+    m_offsets[0] = -stride;
+    m_offsets[1] = -1;
+    m_offsets[2] = stride;
+    m_offsets[3] = 1;
+
+    const int ringOffsets[] {-stride, -stride + 1, 1, stride + 1, stride, stride - 1, -1, -stride - 1};
+    std::copy(std::begin(ringOffsets), std::end(ringOffsets), m_ringOffsets);
+
+    const auto nodeCount = cellCount + std::min((nodeCountPerCell - 1) * cellCount, maxSpareNodeCount);
+
+    m_parents.resize(nodeCount);
+    m_sizes.resize(nodeCount);
+    m_nodes.resize(cellCount);
+    m_nextNode = cellCount;
+
+    m_marks.assign(cellCount, 0);
+    m_currentMark = 0;
+    m_stack.reserve(cellCount);
+
+    m_rootLabels.resize(nodeCount);
+    m_rootMarks.assign(nodeCount, 0);
+    m_currentRootMark = 0;
+
+    for (auto i = 0; i < cellCount; i++)
+    {
+        m_nodes[i] = i;
+        m_parents[i] = i;
+        m_sizes[i] = 1;
+    }
+
+    advanceMark(1);
+
+    for (auto i = 0; i < cellCount; i++)
+    {
+        if (isPassable(board[i]) && m_marks[i] != m_currentMark)
+            relabel(board, i);
+    }
+}
+
+/*
+ * Must be called after the passability of the cell has changed
+ */
+void PassableRegions::update(const Board& board, const int index)
+{
+    COLORLINES_TIME(RegionUpdate);
+    COLORLINES_COUNT(RegionUpdates, 1);
+
+    if (isPassable(board[index]))
+    {
+        if (m_nextNode == static_cast <int>(m_parents.size()))
+        {
+            rebuild(board);
+            return;
+        }
+
+        const auto node = m_nextNode++;
+
+        m_nodes[index] = node;
+        m_parents[node] = node;
+        m_sizes[node] = 1;
+
+        for (const auto offset : m_offsets)
+        {
+            if (isPassable(board[index + offset]))
+                join(node, m_nodes[index + offset]);
+        }
+    }
+    else if (maySplit(board, index))
+    {
+        split(board, index);
+    }
+}
+
+int PassableRegions::getNodeCount() const
+{
+    return static_cast <int>(m_parents.size());
+}
+
+/*
+ * Roots are numbered as they are met, so a new labelling only takes a new mark instead of clearing the nodes
+ */
+int PassableRegions::labelRegions(const Board& board, std::vector <int>& labels) const
+{
+    const auto cellCount = board.getCellCount();
+    labels.resize(cellCount);
+
+    if (++m_currentRootMark == 0)
+    {
+        std::fill(m_rootMarks.begin(), m_rootMarks.end(), 0);
+        m_currentRootMark = 1;
+    }
+
+    auto regionCount = 0;
+
+    for (auto i = 0; i < cellCount; i++)
+    {
+        if (!isPassable(board[i]))
+        {
+            labels[i] = -1;
+            continue;
+        }
+
+        const auto root = getRegion(i);
+
+        if (m_rootMarks[root] != m_currentRootMark)
+        {
+            m_rootMarks[root] = m_currentRootMark;
+            m_rootLabels[root] = regionCount++;
+        }
+
+        labels[i] = m_rootLabels[root];
+    }
+
+    return regionCount;
+}
+
+/*
+ * Cells are marked as visited with the current mark, so the marks never need clearing
+ * unless the counter wraps around
+ * Several marks can be taken at once, the last of them becomes the current one
+ */
+void PassableRegions::advanceMark(const std::uint32_t count)
+{
+    if (m_currentMark > std::numeric_limits <std::uint32_t>::max() - count)
+    {
+        std::fill(m_marks.begin(), m_marks.end(), 0);
+        m_currentMark = 0;
+    }
+
+    m_currentMark += count;
+}
+
+void PassableRegions::join(const int first, const int second)
+{
+    auto firstRoot = findRoot(first);
+    auto secondRoot = findRoot(second);
+
+    if (firstRoot == secondRoot)
+        return;
+
+    // The smaller tree is attached to the bigger one
+    if (m_sizes[firstRoot] < m_sizes[secondRoot])
+        std::swap(firstRoot, secondRoot);
+
+    m_parents[secondRoot] = firstRoot;
+    m_sizes[firstRoot] += m_sizes[secondRoot];
+}
+
+/*
+ * The neighbours of the blocked cell stay connected if they are linked by passable cells
+ * of the ring around it: consecutive cells of the ring are neighbours too
+ * So, the region may split only if the passable neighbours lie on more than one passable arc of the ring
+ */
+bool PassableRegions::maySplit(const Board& board, const int index) const
+{
+    // The walk starts after a blocked cell of the ring, so no arc is cut by the start
+    auto start = 0;
+    while (start < 8 && isPassable(board[index + m_ringOffsets[start]]))
+        start++;
+
+    if (start == 8)
+        return false;
+
+    auto arcCount = 0;
+    auto hasNeighbour = false;
+
+    for (auto step = 1; step <= 8; step++)
+    {
+        const auto position = (start + step) % 8;
+
+        if (isPassable(board[index + m_ringOffsets[position]]))
+        {
+            hasNeighbour = hasNeighbour || (position % 2 == 0);
+        }
+        else
+        {
+            // An arc of corners only has no neighbours to keep connected
+            if (hasNeighbour)
+                arcCount++;
+
+            hasNeighbour = false;
+        }
+    }
+
+    return arcCount > 1;
+}
+
+/*
+ * The blocked cell has divided its region into at most four parts, each of them contains a neighbour of the cell
+ * A search runs from every neighbour, the searches take one cell each in turn, and the searches that meet are joined
+ * A group of searches that has run out of cells has found a whole part, so the work is bounded by the smaller parts
+ * Usually all the searches meet after a few cells, and nothing changes
+ */
+void PassableRegions::split(const Board& board, const int index)
+{
+    COLORLINES_COUNT(RegionSplitChecks, 1);
+
+    // Every search has its own mark, and the groups of searches are a tiny union-find forest of their own
+    int groups[4];
+    std::size_t heads[4];
+    auto searchCount = 0;
+
+    for (const auto offset : m_offsets)
+    {
+        if (isPassable(board[index + offset]))
+        {
+            groups[searchCount] = searchCount;
+            heads[searchCount] = 0;
+            m_searches[searchCount].assign(1, index + offset);
+            searchCount++;
+        }
+    }
+
+    advanceMark(searchCount);
+    const auto firstMark = m_currentMark - searchCount + 1;
+
+    for (auto i = 0; i < searchCount; i++)
+        m_marks[m_searches[i][0]] = firstMark + i;
+
+    const auto getGroup = [&groups](int search)
+    {
+        while (groups[search] != search)
+            search = groups[search];
+
+        return search;
+    };
+
+    // The groups that are neither joined to others nor found to be whole parts
+    auto openGroupCount = searchCount;
+    bool isFound[4] {false, false, false, false};
+
+    while (openGroupCount > 1)
+    {
+        for (auto i = 0; i < searchCount; i++)
+        {
+            if (heads[i] == m_searches[i].size())
+                continue;
+
+            const auto cell = m_searches[i][heads[i]++];
+
+            for (const auto offset : m_offsets)
+            {
+                const auto neighbour = cell + offset;
+
+                if (!isPassable(board[neighbour]))
+                    continue;
+
+                // Other marks wrap around to big numbers
+                const auto search = m_marks[neighbour] - firstMark;
+
+                if (search < static_cast <std::uint32_t>(searchCount))
+                {
+                    const auto group = getGroup(i);
+                    const auto otherGroup = getGroup(search);
+
+                    if (group != otherGroup)
+                    {
+                        groups[otherGroup] = group;
+                        openGroupCount--;
+                    }
+                }
+                else
+                {
+                    m_marks[neighbour] = firstMark + i;
+                    m_searches[i].push_back(neighbour);
+                }
+            }
+        }
+
+        for (auto group = 0; group < searchCount && openGroupCount > 1; group++)
+        {
+            if (groups[group] != group || isFound[group])
+                continue;
+
+            bool isInGroup[4] {false, false, false, false};
+            auto isWhole = true;
+
+            for (auto i = 0; i < searchCount; i++)
+            {
+                isInGroup[i] = (getGroup(i) == group);
+                isWhole = isWhole && (!isInGroup[i] || heads[i] == m_searches[i].size());
+            }
+
+            if (!isWhole)
+                continue;
+
+            isFound[group] = true;
+            openGroupCount--;
+
+            if (!moveToNewNodes(board, isInGroup, searchCount))
+                return;
+        }
+    }
+
+    for (auto i = 0; i < searchCount; i++)
+        COLORLINES_COUNT(RegionSearchCells, m_searches[i].size());
+}
+
+/*
+ * The cells of a part get new nodes under a new root, the old nodes stay in the trees of the other parts
+ * Returns false if the nodes have run out and the forest has been rebuilt instead
+ */
+bool PassableRegions::moveToNewNodes(const Board& board, const bool (&isInGroup)[4], const int searchCount)
+{
+    auto size = 0;
+    for (auto i = 0; i < searchCount; i++)
+    {
+        if (isInGroup[i])
+            size += static_cast <int>(m_searches[i].size());
+    }
+
+    if (m_nextNode + size > static_cast <int>(m_parents.size()))
+    {
+        rebuild(board);
+        return false;
+    }
+
+    const auto root = m_nextNode;
+
+    for (auto i = 0; i < searchCount; i++)
+    {
+        if (!isInGroup[i])
+            continue;
+
+        for (const auto cell : m_searches[i])
+        {
+            m_nodes[cell] = m_nextNode;
+            m_parents[m_nextNode] = root;
+            m_nextNode++;
+        }
+    }
+
+    COLORLINES_COUNT(RegionRelabelCells, size);
+
+    m_sizes[root] = size;
+    return true;
+}
+
+/*
+ * Makes the node of the cell the root of all the passable cells connected to it
+ * Dead nodes may still point into the old trees, but no passable cell reaches them any more
+ * Returns the size of the region
+ */
+int PassableRegions::relabel(const Board& board, const int start)
+{
+    const auto root = m_nodes[start];
+    auto size = 0;
+
+    m_marks[start] = m_currentMark;
+    m_stack.push_back(start);
+
+    while (!m_stack.empty())
+    {
+        const auto index = m_stack.back();
+        m_stack.pop_back();
+
+        m_parents[m_nodes[index]] = root;
+        size++;
+
+        for (const auto offset : m_offsets)
+        {
+            const auto neighbour = index + offset;
+
+            if (isPassable(board[neighbour]) && m_marks[neighbour] != m_currentMark)
+            {
+                m_marks[neighbour] = m_currentMark;
+                m_stack.push_back(neighbour);
+            }
+        }
+    }
+
+    COLORLINES_COUNT(RegionRelabelCells, size);
+
+    m_sizes[root] = size;
+    return size;
+}
@@ -0,0 +1,102 @@
+#include "PathFinder.hpp"
+#include "Instrumentation.hpp"
+
+#include <algorithm>
+
+PathFinder::PathFinder() : m_currentMark(0)
+{
+    //ctor
+}
+
+PathFinder::PathFinder(const PathFinder&) : m_currentMark(0)
+{
+    //ctor
+}
+
+PathFinder& PathFinder::operator=(const PathFinder&)
+{
+    return *this;
+}
+
+PathFinder::~PathFinder()
+{
+    //dtor
+}
+
+void PathFinder::resize(const Board& board)
+{
+    const auto cellCount = board.getCellCount();
+
+    m_marks.assign(cellCount, 0);
+    m_currentMark = 0;
+    m_queue.resize(cellCount);
+    m_parents.resize(cellCount);
+}
+
+/*
+ * Neighbours are taken in the same order as the path checks of the engine: up, left, down, right
+ * The border is not passable, so the neighbours are always inside the buffer
+ */
+bool PathFinder::find(const Board& board, const int sourceIndex, const int destinationIndex, std::vector <int>& path)
+{
+    COLORLINES_TIME(FindPath);
+
+    path.clear();
+
+    if (static_cast <int>(m_marks.size()) != board.getCellCount())
+        resize(board);
+
+    // The marks wrap around once in four billion searches, and then the grid is cleared
+    if (++m_currentMark == 0)
+    {
+        std::fill(m_marks.begin(), m_marks.end(), 0);
+        m_currentMark = 1;
+    }
+
+    const auto stride = board.getStride();
+    const int offsets[] {-stride, -1, stride, 1};
+
+    auto head = 0;
+    auto tail = 0;
+
+    m_marks[sourceIndex] = m_currentMark;
+    m_queue[tail++] = sourceIndex;
+
+    auto isFound = (sourceIndex == destinationIndex);
+
+    while (head < tail && !isFound)
+    {
+        const auto index = m_queue[head++];
+
+        for (const auto offset : offsets)
+        {
+            const auto nextIndex = index + offset;
+
+            if (m_marks[nextIndex] == m_currentMark || !isPassable(board[nextIndex]))
+                continue;
+
+            m_marks[nextIndex] = m_currentMark;
+            m_parents[nextIndex] = index;
+            m_queue[tail++] = nextIndex;
+
+            if (nextIndex == destinationIndex)
+            {
+                isFound = true;
+                break;
+            }
+        }
+    }
+
+    COLORLINES_COUNT(PathSearchCells, head);
+
+    if (!isFound)
+        return false;
+
+    for (auto index = destinationIndex; index != sourceIndex; index = m_parents[index])
+        path.push_back(index);
+
+    path.push_back(sourceIndex);
+    std::reverse(path.begin(), path.end());
+
+    return true;
+}
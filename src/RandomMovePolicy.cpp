@@ -0,0 +1,27 @@
+#include "RandomMovePolicy.hpp"
+
+RandomMovePolicy::RandomMovePolicy()
+{
+    //ctor
+}
+
+RandomMovePolicy::~RandomMovePolicy()
+{
+    //dtor
+}
+
+void RandomMovePolicy::setSeed(const std::uint64_t seed)
+{
+    m_random.setSeed(seed);
+}
+
+bool RandomMovePolicy::chooseMove(const GameEngine& game, Move& move)
+{
+    game.generateMoves(m_moves);
+
+    if (m_moves.empty())
+        return false;
+
+    move = m_moves[m_random.getInteger(0, m_moves.size())];
+    return true;
+}
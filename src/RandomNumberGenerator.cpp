@@ -1,19 +1,162 @@
 #include "RandomNumberGenerator.hpp"
 
-RandomNumberGenerator::RandomNumberGenerator() : m_engine(std::chrono::system_clock::now().time_since_epoch().count())
+RandomNumberGenerator::RandomNumberGenerator() :
+    RandomNumberGenerator(Algorithm::Xoshiro256StarStar)
 {
     //ctor
 }
 
+RandomNumberGenerator::RandomNumberGenerator(const Algorithm algorithm) : m_algorithm(algorithm)
+{
+    setSeed(std::chrono::system_clock::now().time_since_epoch().count());
+}
+
+RandomNumberGenerator::RandomNumberGenerator(const RandomNumberGenerator& other) :
+    m_algorithm(other.m_algorithm),
+    m_seed(other.m_seed),
+    m_hasSeed(other.m_hasSeed),
+    m_words(other.m_words)
+{
+    if (other.m_mersenneTwister)
+        m_mersenneTwister = std::make_unique <std::mt19937>(*other.m_mersenneTwister);
+}
+
+RandomNumberGenerator& RandomNumberGenerator::operator=(const RandomNumberGenerator& other)
+{
+    if (this == &other)
+        return *this;
+
+    m_algorithm = other.m_algorithm;
+    m_seed = other.m_seed;
+    m_hasSeed = other.m_hasSeed;
+    m_words = other.m_words;
+
+    if (!other.m_mersenneTwister)
+        m_mersenneTwister.reset();
+    else if (m_mersenneTwister)
+        *m_mersenneTwister = *other.m_mersenneTwister;
+    else
+        m_mersenneTwister = std::make_unique <std::mt19937>(*other.m_mersenneTwister);
+
+    return *this;
+}
+
 RandomNumberGenerator::~RandomNumberGenerator()
 {
     //dtor
 }
 
-int RandomNumberGenerator::getInteger(const int inclusiveMinValue, const int exclusiveMaxValue)
+void RandomNumberGenerator::setAlgorithm(const Algorithm algorithm)
+{
+    m_algorithm = algorithm;
+    setSeed(m_seed);
+}
+
+RandomNumberGenerator::Algorithm RandomNumberGenerator::getAlgorithm() const
+{
+    return m_algorithm;
+}
+
+void RandomNumberGenerator::setSeed(const std::uint64_t seed)
+{
+    m_seed = seed;
+    m_hasSeed = true;
+
+    switch (m_algorithm)
+    {
+        case Algorithm::Xoshiro256StarStar:
+        {
+            // SplitMix64 never gives four zero words, which xoshiro cannot leave
+            for (size_t i = 0; i < m_words.size(); i++)
+                m_words[i] = mixSeed(seed, i);
+
+            m_mersenneTwister.reset();
+            break;
+        }
+
+        case Algorithm::Pcg32:
+        {
+            // The increment must be odd, the first step mixes the seed into the state
+            m_words = {0, (mixSeed(seed, 1) << 1) | 1, 0, 0};
+            getNext();
+            m_words[0] += mixSeed(seed, 0);
+            getNext();
+
+            m_mersenneTwister.reset();
+            break;
+        }
+
+        default:
+        {
+            if (!m_mersenneTwister)
+                m_mersenneTwister = std::make_unique <std::mt19937>();
+
+            std::seed_seq sequence {static_cast <std::uint32_t>(seed), static_cast <std::uint32_t>(seed >> 32)};
+            m_mersenneTwister->seed(sequence);
+            m_words = {0, 0, 0, 0};
+            break;
+        }
+    }
+}
+
+bool RandomNumberGenerator::hasSeed() const
+{
+    return m_hasSeed;
+}
+
+std::uint64_t RandomNumberGenerator::getSeed() const
+{
+    return m_seed;
+}
+
+bool RandomNumberGenerator::isAtSeed() const
+{
+    if (!m_hasSeed)
+        return false;
+
+    // mt19937 counts the values drawn, and a copy of it would take 5 KB
+    if (m_algorithm == Algorithm::MersenneTwister)
+        return m_words[0] == 0;
+
+    RandomNumberGenerator seeded(m_algorithm);
+    seeded.setSeed(m_seed);
+    return seeded.m_words == m_words;
+}
+
+RandomNumberGenerator::State RandomNumberGenerator::getState() const
+{
+    if (m_algorithm == Algorithm::MersenneTwister)
+        return State {m_algorithm, {m_seed, m_words[0], 0, 0}};
+
+    return State {m_algorithm, m_words};
+}
+
+void RandomNumberGenerator::setState(const State& state)
+{
+    m_algorithm = state.algorithm;
+
+    if (m_algorithm == Algorithm::MersenneTwister)
+    {
+        setSeed(state.words[0]);
+        m_mersenneTwister->discard(state.words[1]);
+        m_words[0] = state.words[1];
+        return;
+    }
+
+    m_words = state.words;
+    m_hasSeed = false;
+    m_mersenneTwister.reset();
+}
+
+/*
+ * SplitMix64 of the sum, so close indices give unrelated seeds
+ */
+std::uint64_t RandomNumberGenerator::mixSeed(const std::uint64_t seed, const std::uint64_t index)
 {
-    std::uniform_int_distribution <int> distribution(inclusiveMinValue, exclusiveMaxValue - 1);
-    return distribution(m_engine);
+    auto z = seed + (index + 1) * 0x9E3779B97F4A7C15;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    return z ^ (z >> 31);
 }
 
 Tile RandomNumberGenerator::getTile(const Tile inclusiveMinValue, const Tile exclusiveMaxValue)
@@ -0,0 +1,250 @@
+#include "ReplayCorpus.hpp"
+
+#include <memory>
+#include <cstdio>
+
+namespace
+{
+    // "CLRC" and "CLRI" read as little-endian numbers
+    constexpr std::uint64_t corpusSignature = 0x43524C43;
+    constexpr std::uint64_t indexSignature = 0x49524C43;
+
+    constexpr int finishedFlag = 1;
+    constexpr int seededFlag = 2;
+}
+
+ReplayCorpus::ReplayCorpus(const std::string& path) :
+    m_file(path),
+    m_index(nullptr),
+    m_gameCount(0),
+    m_checkpointInterval(64),
+    m_checkpointGame(-1)
+{
+    const auto data = m_file.getData();
+    const auto size = m_file.getSize();
+
+    if (size < m_headerSize + m_footerSize ||
+        getInteger(data, 4) != corpusSignature ||
+        getInteger(data + 4, 4) != m_version)
+    {
+        throw std::runtime_error("Not a replay corpus " + path);
+    }
+
+    const auto footer = data + size - m_footerSize;
+    const auto indexOffset = getInteger(footer, 8);
+    const auto gameCount = getInteger(footer + 8, 8);
+
+    if (getInteger(footer + 16, 4) != indexSignature || getInteger(footer + 20, 4) != m_version ||
+        indexOffset < m_headerSize || indexOffset + gameCount * m_entrySize + m_footerSize != size)
+    {
+        throw std::runtime_error("Damaged replay corpus " + path);
+    }
+
+    m_index = data + indexOffset;
+    m_gameCount = static_cast <int>(gameCount);
+}
+
+ReplayCorpus::~ReplayCorpus()
+{
+    //dtor
+}
+
+/*
+ * The bytes of the games are copied as they are, only the index is new
+ */
+int ReplayCorpus::build(const std::string& path, const std::vector <std::string>& replayPaths)
+{
+    std::unique_ptr <std::FILE, int (*)(std::FILE*)> file(std::fopen(path.c_str(), "wb"), &std::fclose);
+    if (!file)
+        throw std::runtime_error("Cannot create file " + path);
+
+    unsigned char header[m_headerSize] {'C', 'L', 'R', 'C'};
+    putInteger(header + 4, m_version, 4);
+    auto isWriteSuccessful = std::fwrite(header, 1, m_headerSize, file.get()) == m_headerSize;
+
+    std::vector <unsigned char> index;
+    std::uint64_t offset = m_headerSize;
+    ReplayGame replay;
+
+    for (const auto& replayPath : replayPaths)
+    {
+        MappedFile replayFile(replayPath);
+        const auto data = replayFile.getData();
+        const auto size = replayFile.getSize();
+
+        if (size < Replay::headerSize ||
+            getInteger(data, 4) != Replay::signature ||
+            getInteger(data + 4, 4) != Replay::version)
+        {
+            throw std::runtime_error("Not a replay file " + replayPath);
+        }
+
+        const auto games = data + Replay::headerSize;
+        ReplayReader reader(games, size - Replay::headerSize);
+
+        while (reader.readGame(replay))
+        {
+            const auto gameSize = reader.getGameEnd() - reader.getGameBegin();
+            isWriteSuccessful = isWriteSuccessful &&
+                                std::fwrite(games + reader.getGameBegin(), 1, gameSize, file.get()) == gameSize;
+
+            unsigned char entry[m_entrySize] {};
+            putInteger(entry, offset, 8);
+            putInteger(entry + 8, replay.seed, 8);
+            putInteger(entry + 16, static_cast <std::uint32_t>(replay.score), 4);
+            putInteger(entry + 20, replay.actions.size(), 4);
+            putInteger(entry + 24, replay.widthInTiles, 2);
+            putInteger(entry + 26, replay.heightInTiles, 2);
+            putInteger(entry + 28, replay.colorCount, 1);
+            putInteger(entry + 29, (replay.isFinished ? finishedFlag : 0) | (replay.isSeeded ? seededFlag : 0), 1);
+
+            index.insert(index.end(), entry, entry + m_entrySize);
+            offset += gameSize;
+        }
+    }
+
+    const auto gameCount = index.size() / m_entrySize;
+
+    unsigned char footer[m_footerSize];
+    putInteger(footer, offset, 8);
+    putInteger(footer + 8, gameCount, 8);
+    putInteger(footer + 16, indexSignature, 4);
+    putInteger(footer + 20, m_version, 4);
+
+    isWriteSuccessful = isWriteSuccessful &&
+                        std::fwrite(index.data(), 1, index.size(), file.get()) == index.size() &&
+                        std::fwrite(footer, 1, m_footerSize, file.get()) == m_footerSize &&
+                        std::fclose(file.release()) == 0;
+
+    if (!isWriteSuccessful)
+        throw std::runtime_error("Cannot write file " + path);
+
+    return static_cast <int>(gameCount);
+}
+
+int ReplayCorpus::getGameCount() const
+{
+    return m_gameCount;
+}
+
+CorpusEntry ReplayCorpus::getEntry(const int game) const
+{
+    if (game < 0 || game >= m_gameCount)
+        throw std::runtime_error("No game " + std::to_string(game) + " in the replay corpus");
+
+    const auto entry = m_index + static_cast <size_t>(game) * m_entrySize;
+    const auto flags = static_cast <int>(getInteger(entry + 29, 1));
+
+    return CorpusEntry {getInteger(entry, 8),
+                        getInteger(entry + 8, 8),
+                        static_cast <int>(static_cast <std::uint32_t>(getInteger(entry + 16, 4))),
+                        static_cast <int>(getInteger(entry + 20, 4)),
+                        static_cast <int>(getInteger(entry + 24, 2)),
+                        static_cast <int>(getInteger(entry + 26, 2)),
+                        static_cast <int>(getInteger(entry + 28, 1)),
+                        (flags & seededFlag) != 0,
+                        (flags & finishedFlag) != 0};
+}
+
+std::vector <int> ReplayCorpus::findGames(const std::function <bool(const CorpusEntry&)>& filter) const
+{
+    std::vector <int> games;
+
+    for (auto i = 0; i < m_gameCount; i++)
+    {
+        if (filter(getEntry(i)))
+            games.push_back(i);
+    }
+
+    return games;
+}
+
+void ReplayCorpus::readGame(const int game, ReplayGame& replay) const
+{
+    // A game ends where the next one or the index begins
+    const auto begin = getEntry(game).offset;
+    const auto end = (game + 1 < m_gameCount) ? getEntry(game + 1).offset : static_cast <std::uint64_t>(m_index - m_file.getData());
+
+    if (end < begin)
+        throw std::runtime_error("Damaged game " + std::to_string(game) + " in the replay corpus");
+
+    ReplayReader reader(m_file.getData() + begin, end - begin);
+
+    if (!reader.readGame(replay))
+        throw std::runtime_error("Damaged game " + std::to_string(game) + " in the replay corpus");
+}
+
+void ReplayCorpus::setCheckpointInterval(const int actionCount)
+{
+    m_checkpointInterval = std::max(1, actionCount);
+    m_checkpointGame = -1;
+    m_checkpoints.clear();
+}
+
+/*
+ * Checkpoints are added only up to the requested action,
+ * so looking at the first moves of many games replays only those moves
+ */
+const GameEngine& ReplayCorpus::getPosition(const int game, const int actionCount)
+{
+    if (game != m_checkpointGame)
+    {
+        // Reset first, so a failed read does not leave the checkpoints of another game
+        m_checkpointGame = -1;
+        m_checkpoints.clear();
+
+        readGame(game, m_game);
+
+        m_checkpointGame = game;
+        m_checkpoints.reserve(m_game.actions.size() / m_checkpointInterval + 1);
+    }
+
+    if (actionCount < 0 || actionCount > static_cast <int>(m_game.actions.size()))
+        throw std::runtime_error("No action " + std::to_string(actionCount) + " in game " + std::to_string(game));
+
+    if (m_checkpoints.empty())
+    {
+        m_position.emplace();
+        ReplayReader::startGame(*m_position, m_game);
+        m_checkpoints.push_back(*m_position);
+    }
+
+    const auto checkpoint = actionCount / m_checkpointInterval;
+
+    while (static_cast <int>(m_checkpoints.size()) <= checkpoint)
+    {
+        const auto firstAction = (static_cast <int>(m_checkpoints.size()) - 1) * m_checkpointInterval;
+        m_position.emplace(m_checkpoints.back());
+
+        for (auto i = firstAction; i < firstAction + m_checkpointInterval; i++)
+            ReplayReader::applyAction(*m_position, m_game, m_game.actions[i]);
+
+        m_checkpoints.push_back(*m_position);
+    }
+
+    m_position.emplace(m_checkpoints[checkpoint]);
+
+    for (auto i = checkpoint * m_checkpointInterval; i < actionCount; i++)
+        ReplayReader::applyAction(*m_position, m_game, m_game.actions[i]);
+
+    return *m_position;
+}
+
+/*
+ * The file is little-endian on any platform
+ */
+void ReplayCorpus::putInteger(unsigned char* data, const std::uint64_t value, const int byteCount)
+{
+    for (auto i = 0; i < byteCount; i++)
+        data[i] = static_cast <unsigned char>(value >> (8 * i));
+}
+
+std::uint64_t ReplayCorpus::getInteger(const unsigned char* data, const int byteCount)
+{
+    std::uint64_t value = 0;
+
+    for (auto i = 0; i < byteCount; i++)
+        value |= static_cast <std::uint64_t>(data[i]) << (8 * i);
+
+    return value;
+}
@@ -0,0 +1,316 @@
+#include "ReplayReader.hpp"
+
+namespace
+{
+    // Bounds of the fields, so a damaged file is reported instead of allocating a huge board
+    // The board has the limits of the engine, so every game read can be played
+    constexpr std::uint64_t minSizeInTiles = GameEngine::m_minSizeInTiles;
+    constexpr std::uint64_t maxSizeInTiles = GameEngine::m_maxSizeInTiles;
+    constexpr std::uint64_t maxColorCount = static_cast <int>(Tile::ColorEnd) - static_cast <int>(Tile::ColorOne);
+    constexpr std::uint64_t maxAlgorithm = static_cast <int>(RandomNumberGenerator::Algorithm::MersenneTwister);
+    constexpr int maxVarintSize = 10;
+}
+
+ReplayReader::ReplayReader(const std::string& path) :
+    m_file(std::fopen(path.c_str(), "rb")),
+    m_buffer(m_bufferSize),
+    m_data(m_buffer.data()),
+    m_dataOffset(0),
+    m_position(0),
+    m_size(0),
+    m_gameBegin(0),
+    m_gameEnd(0),
+    m_isStartPending(false)
+{
+    if (m_file == nullptr)
+        throw std::runtime_error("Cannot open file " + path);
+
+    std::uint64_t signature = 0;
+    std::uint64_t version = 0;
+
+    if (!getInteger(signature, 4) || !getInteger(version, 4) ||
+        signature != Replay::signature || version != Replay::version)
+    {
+        std::fclose(m_file);
+        throw std::runtime_error("Not a replay file " + path);
+    }
+}
+
+ReplayReader::ReplayReader(const unsigned char* data, const size_t size) :
+    m_file(nullptr),
+    m_data(data),
+    m_dataOffset(0),
+    m_position(0),
+    m_size(size),
+    m_gameBegin(0),
+    m_gameEnd(0),
+    m_isStartPending(false)
+{
+    //ctor
+}
+
+ReplayReader::~ReplayReader()
+{
+    if (m_file != nullptr)
+        std::fclose(m_file);
+}
+
+bool ReplayReader::readGame(ReplayGame& replay)
+{
+    std::uint64_t key = 0;
+
+    // The start found after the previous game begins where that game ends
+    m_gameBegin = m_isStartPending ? m_gameEnd : getOffset();
+
+    if (!m_isStartPending)
+    {
+        if (!getVarint(key))
+            return false;
+
+        if ((key & ((1 << Replay::typeBitCount) - 1)) != static_cast <std::uint64_t>(ReplayRecordType::Start))
+            throw std::runtime_error("Damaged replay: a game does not begin with its start");
+    }
+
+    m_isStartPending = false;
+
+    if (!readStart(replay))
+        return false;
+
+    replay.actions.clear();
+    replay.isFinished = false;
+    replay.score = 0;
+
+    std::int64_t time = 0;
+
+    while (true)
+    {
+        m_gameEnd = getOffset();
+
+        if (!getVarint(key))
+            return true;
+
+        ReplayAction action {static_cast <ReplayRecordType>(key & ((1 << Replay::typeBitCount) - 1)), 0, -1, -1};
+        time += static_cast <std::int64_t>(key >> Replay::typeBitCount);
+        action.time = time;
+
+        switch (action.type)
+        {
+            case ReplayRecordType::Start:
+            {
+                m_isStartPending = true;
+                return true;
+            }
+
+            case ReplayRecordType::Pick:
+            {
+                if (!getCell(replay, action.firstCell))
+                    return true;
+                break;
+            }
+
+            case ReplayRecordType::Move:
+            {
+                if (!getCell(replay, action.firstCell) || !getCell(replay, action.secondCell))
+                    return true;
+                break;
+            }
+
+            case ReplayRecordType::Undo:
+            case ReplayRecordType::Redo:
+                break;
+
+            case ReplayRecordType::End:
+            {
+                std::uint64_t score = 0;
+                if (!getVarint(score))
+                    return true;
+
+                replay.isFinished = true;
+                replay.score = static_cast <int>(score);
+                m_gameEnd = getOffset();
+                return true;
+            }
+
+            default:
+                throw std::runtime_error("Damaged replay: unknown record");
+        }
+
+        replay.actions.push_back(action);
+    }
+}
+
+std::uint64_t ReplayReader::getGameBegin() const
+{
+    return m_gameBegin;
+}
+
+std::uint64_t ReplayReader::getGameEnd() const
+{
+    return m_gameEnd;
+}
+
+bool ReplayReader::replayGame(GameEngine& game, const ReplayGame& replay)
+{
+    startGame(game, replay);
+
+    for (const auto& action : replay.actions)
+        applyAction(game, replay, action);
+
+    return !replay.isFinished || game.getScore() == replay.score;
+}
+
+void ReplayReader::startGame(GameEngine& game, const ReplayGame& replay)
+{
+    if (replay.isSeeded)
+    {
+        game.setRandomAlgorithm(replay.randomState.algorithm);
+        game.setRandomSeed(replay.seed);
+    }
+    else
+    {
+        game.setRandomState(replay.randomState);
+    }
+
+    game.startNewGame(replay.widthInTiles, replay.heightInTiles, replay.colorCount);
+}
+
+void ReplayReader::applyAction(GameEngine& game, const ReplayGame& replay, const ReplayAction& action)
+{
+    const auto width = replay.widthInTiles;
+
+    switch (action.type)
+    {
+        case ReplayRecordType::Pick:
+            game.processPick(action.firstCell / width, action.firstCell % width);
+            break;
+
+        case ReplayRecordType::Move:
+            game.applyMove(Move {action.firstCell / width, action.firstCell % width,
+                                 action.secondCell / width, action.secondCell % width});
+            break;
+
+        case ReplayRecordType::Undo:
+            game.undo();
+            break;
+
+        case ReplayRecordType::Redo:
+            game.redo();
+            break;
+
+        default:
+            break;
+    }
+}
+
+std::uint64_t ReplayReader::getOffset() const
+{
+    return m_dataOffset + m_position;
+}
+
+/*
+ * The file is read in large blocks, so the records cost no call each
+ */
+bool ReplayReader::getByte(unsigned char& byte)
+{
+    if (m_position == m_size)
+    {
+        if (m_file == nullptr)
+            return false;
+
+        m_dataOffset += m_size;
+        m_size = std::fread(m_buffer.data(), 1, m_buffer.size(), m_file);
+        m_position = 0;
+
+        if (m_size == 0)
+            return false;
+    }
+
+    byte = m_data[m_position++];
+    return true;
+}
+
+bool ReplayReader::getVarint(std::uint64_t& value)
+{
+    value = 0;
+
+    for (auto i = 0; i < maxVarintSize; i++)
+    {
+        unsigned char byte = 0;
+        if (!getByte(byte))
+            return false;
+
+        value |= static_cast <std::uint64_t>(byte & 0x7F) << (7 * i);
+
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+
+    throw std::runtime_error("Damaged replay: too long number");
+}
+
+bool ReplayReader::getInteger(std::uint64_t& value, const int byteCount)
+{
+    value = 0;
+
+    for (auto i = 0; i < byteCount; i++)
+    {
+        unsigned char byte = 0;
+        if (!getByte(byte))
+            return false;
+
+        value |= static_cast <std::uint64_t>(byte) << (8 * i);
+    }
+
+    return true;
+}
+
+bool ReplayReader::getCell(const ReplayGame& replay, int& cell)
+{
+    std::uint64_t value = 0;
+    if (!getVarint(value))
+        return false;
+
+    if (value >= static_cast <std::uint64_t>(replay.widthInTiles) * replay.heightInTiles)
+        throw std::runtime_error("Damaged replay: a cell is out of the board");
+
+    cell = static_cast <int>(value);
+    return true;
+}
+
+/*
+ * Returns false if the file ends inside the record
+ */
+bool ReplayReader::readStart(ReplayGame& replay)
+{
+    std::uint64_t width = 0;
+    std::uint64_t height = 0;
+    std::uint64_t colorCount = 0;
+    std::uint64_t generator = 0;
+
+    if (!getVarint(width) || !getVarint(height) || !getVarint(colorCount) || !getVarint(generator))
+        return false;
+
+    if (width < minSizeInTiles || width > maxSizeInTiles || height < minSizeInTiles || height > maxSizeInTiles ||
+        colorCount < 1 || colorCount > maxColorCount || (generator >> 1) > maxAlgorithm)
+    {
+        throw std::runtime_error("Damaged replay: wrong start of a game");
+    }
+
+    replay.widthInTiles = static_cast <int>(width);
+    replay.heightInTiles = static_cast <int>(height);
+    replay.colorCount = static_cast <int>(colorCount);
+    replay.isSeeded = (generator & 1) != 0;
+    replay.seed = 0;
+    replay.randomState = RandomNumberGenerator::State {static_cast <RandomNumberGenerator::Algorithm>(generator >> 1), {0, 0, 0, 0}};
+
+    if (replay.isSeeded)
+        return getInteger(replay.seed, 8);
+
+    for (auto& word : replay.randomState.words)
+    {
+        if (!getInteger(word, 8))
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,164 @@
+#include "ReplayRecorder.hpp"
+
+#include <mutex>
+
+namespace
+{
+    // Serializes the writes of all recorders, so the ones sharing a file append whole games
+    std::mutex fileMutex;
+}
+
+ReplayRecorder::ReplayRecorder(const std::string& path) :
+    m_file(std::fopen(path.c_str(), "ab")),
+    m_isGameStarted(false),
+    m_widthInTiles(0)
+{
+    if (m_file == nullptr)
+        throw std::runtime_error("Cannot open file " + path);
+
+    m_buffer.reserve(m_bufferLimit);
+
+    std::lock_guard <std::mutex> lock(fileMutex);
+
+    if (std::fseek(m_file, 0, SEEK_END) == 0 && std::ftell(m_file) == 0)
+    {
+        m_buffer.insert(m_buffer.end(), {'C', 'L', 'R', 'P'});
+        putInteger(Replay::version, 4);
+
+        const auto isWriteSuccessful = std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) == m_buffer.size() &&
+                                       std::fflush(m_file) == 0;
+        m_buffer.clear();
+
+        if (!isWriteSuccessful)
+        {
+            std::fclose(m_file);
+            throw std::runtime_error("Cannot write file " + path);
+        }
+    }
+}
+
+ReplayRecorder::~ReplayRecorder()
+{
+    // There is nobody to report the error to
+    write();
+    std::fclose(m_file);
+}
+
+void ReplayRecorder::startGame(const int widthInTiles,
+                               const int heightInTiles,
+                               const int colorCount,
+                               const RandomNumberGenerator& random)
+{
+    m_isGameStarted = true;
+    m_widthInTiles = widthInTiles;
+    m_lastRecordTime = std::chrono::steady_clock::now();
+
+    putRecord(ReplayRecordType::Start);
+    putVarint(widthInTiles);
+    putVarint(heightInTiles);
+    putVarint(colorCount);
+
+    const auto isSeeded = random.isAtSeed();
+    putVarint((static_cast <std::uint64_t>(random.getAlgorithm()) << 1) | (isSeeded ? 1 : 0));
+
+    if (isSeeded)
+    {
+        putInteger(random.getSeed(), 8);
+        return;
+    }
+
+    for (const auto word : random.getState().words)
+        putInteger(word, 8);
+}
+
+void ReplayRecorder::recordPick(const int row, const int column)
+{
+    putRecord(ReplayRecordType::Pick);
+    putVarint(row * m_widthInTiles + column);
+}
+
+void ReplayRecorder::recordMove(const Move& move)
+{
+    putRecord(ReplayRecordType::Move);
+    putVarint(move.sourceRow * m_widthInTiles + move.sourceColumn);
+    putVarint(move.destinationRow * m_widthInTiles + move.destinationColumn);
+}
+
+void ReplayRecorder::recordUndo()
+{
+    putRecord(ReplayRecordType::Undo);
+}
+
+void ReplayRecorder::recordRedo()
+{
+    putRecord(ReplayRecordType::Redo);
+}
+
+void ReplayRecorder::endGame(const int score)
+{
+    putRecord(ReplayRecordType::End);
+    putVarint(score);
+    m_isGameStarted = false;
+
+    if (m_buffer.size() >= m_bufferLimit)
+        flush();
+}
+
+bool ReplayRecorder::isGameStarted() const
+{
+    return m_isGameStarted;
+}
+
+void ReplayRecorder::flush()
+{
+    if (!write())
+        throw std::runtime_error("Cannot write the replay");
+}
+
+/*
+ * The time is kept as a delta, so records made within a millisecond take a single byte
+ */
+void ReplayRecorder::putRecord(const ReplayRecordType type)
+{
+    const auto now = std::chrono::steady_clock::now();
+    const auto delta = std::chrono::duration_cast <std::chrono::milliseconds>(now - m_lastRecordTime).count();
+
+    // The remainder of a millisecond is carried to the next record
+    m_lastRecordTime += std::chrono::milliseconds(delta);
+
+    putVarint((static_cast <std::uint64_t>(delta) << Replay::typeBitCount) | static_cast <std::uint64_t>(type));
+}
+
+/*
+ * 7 bits per byte starting from the lowest ones, the high bit is set in all bytes but the last one
+ */
+void ReplayRecorder::putVarint(std::uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        m_buffer.push_back(static_cast <unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+
+    m_buffer.push_back(static_cast <unsigned char>(value));
+}
+
+void ReplayRecorder::putInteger(const std::uint64_t value, const int byteCount)
+{
+    for (auto i = 0; i < byteCount; i++)
+        m_buffer.push_back(static_cast <unsigned char>(value >> (8 * i)));
+}
+
+bool ReplayRecorder::write()
+{
+    if (m_buffer.empty())
+        return true;
+
+    std::lock_guard <std::mutex> lock(fileMutex);
+
+    const auto isWriteSuccessful = std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) == m_buffer.size() &&
+                                   std::fflush(m_file) == 0;
+    m_buffer.clear();
+
+    return isWriteSuccessful;
+}
@@ -1,6 +1,12 @@
 #include "ResourceManager.hpp"
 
-ResourceManager::ResourceManager() : m_spriteSizeInPixels(64), m_directoryName("resources/")
+#include <cstddef>
+
+// Written by colorlines_pack at build time
+extern const unsigned char assetBundleData[];
+extern const std::size_t assetBundleSize;
+
+ResourceManager::ResourceManager() : m_spriteSizeInPixels(0)
 {
     //ctor
 }
@@ -10,85 +16,45 @@ ResourceManager::~ResourceManager()
     //dtor
 }
 
-void ResourceManager::loadFont()
-{
-    auto relativePath = m_directoryName + "DigitalNumbers-Regular.ttf";
-
-    auto isLoadSuccessful = m_font.loadFromFile(relativePath);
-    if (!isLoadSuccessful)
-        throw std::runtime_error("Cannot load file " + relativePath);
-}
-
-void ResourceManager::loadSprite(sf::Texture& texture, sf::Sprite& sprite, const std::string& relativePath)
+/*
+ * The pixels are copied to the texture as they are,
+ * and the font reads the bundle in place, which lives as long as the game
+ */
+void ResourceManager::load()
 {
-    auto isLoadSuccessful = texture.loadFromFile(relativePath);
+    const AssetBundle bundle(assetBundleData, assetBundleSize);
 
-    if (!isLoadSuccessful)
-        throw std::runtime_error("Cannot load file " + relativePath);
+    if (!m_atlasTexture.create(bundle.getAtlasWidth(), bundle.getAtlasHeight()))
+        throw std::runtime_error("Cannot create the texture atlas");
 
-    texture.setSmooth(true);
-    sprite.setTexture(texture);
-    sprite.setScale(m_spriteSizeInPixels / sprite.getLocalBounds().width,
-                    m_spriteSizeInPixels / sprite.getLocalBounds().height);
-}
+    m_atlasTexture.update(bundle.getAtlasPixels());
+    m_atlasTexture.setSmooth(true);
 
-/*
- * This internal function makes a scaled sprite
- * The difference between setScale is that the scale of the sprite stays the same,
- * but its texture rectangle gets resized
-*/
-void ResourceManager::loadScaledSprite(const sf::Texture& texture, sf::Sprite& sprite, float factor)
-{
-    /*
-     * Let 'x' be the original width of texture and 'a' the resize factor
-     * Then ax will be resized width
-     * We place the new texture at the center of the old one
-     * So, the new texture has width:
-     * (ax - x) / 2 to the left, (ax - x) / 2 to the right of old texture and x in the center
-     * Top left corner of rectangle is placed in -(ax - x), the width is ax
-     *
-     * Small trick:
-     * 1. Texture rectangle is enlarged to make sprite smaller
-     * 2. Texture rectangle is shrinked to make sprite bigger
-     * So, the factor should be reversed to make external usage intuitive
-     *
-     * Same math for the height
-    */
-
-    factor = 1 / factor;
+    for (auto i = 0; i < static_cast <int>(Tile::Count); i++)
+    {
+        const auto rect = bundle.getTextureRect(static_cast <Tile>(i));
+        m_textureRects[i] = sf::IntRect(rect.left, rect.top, rect.width, rect.height);
+    }
 
-    sprite.setTexture(texture);
-    sprite.setTextureRect(sf::IntRect(sprite.getLocalBounds().width  * (1.0f - factor) / 2,
-                                      sprite.getLocalBounds().height * (1.0f - factor) / 2,
-                                      sprite.getLocalBounds().width  * factor,
-                                      sprite.getLocalBounds().height * factor));
+    m_spriteSizeInPixels = bundle.getSpriteSize();
 
-    sprite.setScale(m_spriteSizeInPixels / sprite.getLocalBounds().width,
-                    m_spriteSizeInPixels / sprite.getLocalBounds().height);
+    if (!m_font.loadFromMemory(bundle.getFontData(), bundle.getFontSize()))
+        throw std::runtime_error("Cannot load the font");
 }
 
-void ResourceManager::loadSprites()
+const sf::Texture& ResourceManager::getAtlasTexture() const
 {
-    loadSprite(m_cellTexture, m_cellSprite, m_directoryName + "cell.png");
-
-    for (auto tile = Tile::ColorOne; tile < Tile::ColorEnd; tile++)
-    {
-        auto fileName = m_directoryName + "ball_" + std::to_string(static_cast <int>(tile)) + ".png";
-        loadSprite(m_ballTextures[tile], m_ballSprites[tile], fileName);
-
-        loadScaledSprite(m_ballTextures[tile], m_ballSprites[normalToExpected(tile)], 0.5f);
-        loadScaledSprite(m_ballTextures[tile], m_ballSprites[normalToSelected(tile)], 1.5f);
-    }
+    return m_atlasTexture;
 }
 
-sf::Sprite ResourceManager::getBallSprite(const Tile tile) const
+const sf::IntRect& ResourceManager::getTextureRect(const Tile tile) const
 {
-    return m_ballSprites.at(tile);
+    return m_textureRects[static_cast <int>(tile)];
 }
 
-sf::Sprite ResourceManager::getCellSprite() const
+const std::array <sf::IntRect, static_cast <int>(Tile::Count)>& ResourceManager::getTextureRects() const
 {
-    return m_cellSprite;
+    return m_textureRects;
 }
 
 int ResourceManager::getSpriteSize() const
@@ -96,7 +62,7 @@ int ResourceManager::getSpriteSize() const
     return m_spriteSizeInPixels;
 }
 
-sf::Font ResourceManager::getFont() const
+const sf::Font& ResourceManager::getFont() const
 {
     return m_font;
 }
@@ -0,0 +1,168 @@
+#include "ResultFile.hpp"
+
+#include <memory>
+#include <utility>
+#include <algorithm>
+
+ResultFile::ResultFile(const std::string& path) : m_file(std::fopen(path.c_str(), "r+b"))
+{
+    if (m_file == nullptr)
+        throw std::runtime_error("Cannot open file " + path);
+}
+
+ResultFile::~ResultFile()
+{
+    std::fclose(m_file);
+}
+
+void ResultFile::create(const std::string& path, const ResultHeader& settings)
+{
+    if (settings.policyName.size() > m_headerSize - m_policyNameOffset)
+        throw std::runtime_error("The name of the policy is too long: " + settings.policyName);
+
+    unsigned char header[m_headerSize] {'C', 'L', 'R', 'S'};
+    putInteger(header + 4, m_version, 4);
+    putInteger(header + 8, m_recordSize, 4);
+    putInteger(header + 12, static_cast <std::uint32_t>(settings.gameCount), 4);
+    putInteger(header + 16, settings.masterSeed, 8);
+    putInteger(header + 24, static_cast <std::uint32_t>(settings.widthInTiles), 4);
+    putInteger(header + 28, static_cast <std::uint32_t>(settings.heightInTiles), 4);
+    putInteger(header + 32, static_cast <std::uint32_t>(settings.colorCount), 4);
+    putInteger(header + 36, static_cast <std::uint32_t>(settings.maxMoveCount), 4);
+    putInteger(header + 40, static_cast <std::uint32_t>(settings.randomAlgorithm), 4);
+    putInteger(header + 48, settings.startPositionHash, 8);
+    std::copy(settings.policyName.begin(), settings.policyName.end(), header + m_policyNameOffset);
+
+    auto file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+        throw std::runtime_error("Cannot create file " + path);
+
+    const auto isWriteSuccessful = std::fwrite(header, 1, m_headerSize, file) == m_headerSize;
+    std::fclose(file);
+
+    if (!isWriteSuccessful)
+        throw std::runtime_error("Cannot write file " + path);
+}
+
+void ResultFile::write(const int firstGameIndex, const std::vector <GameRecord>& records)
+{
+    m_buffer.resize(records.size() * m_recordSize);
+
+    auto data = m_buffer.data();
+    for (const auto& record : records)
+    {
+        putInteger(data, record.seed, 8);
+        putInteger(data + 8, static_cast <std::uint32_t>(record.score), 4);
+        putInteger(data + 12, static_cast <std::uint32_t>(record.moveCount), 4);
+        data += m_recordSize;
+    }
+
+    const auto offset = m_headerSize + static_cast <long>(firstGameIndex) * m_recordSize;
+
+    // Seeking past the end is fine: the gap is filled by the threads that own those games
+    if (std::fseek(m_file, offset, SEEK_SET) != 0 ||
+        std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) != m_buffer.size() ||
+        std::fflush(m_file) != 0)
+    {
+        throw std::runtime_error("Cannot write game results");
+    }
+}
+
+ResultHeader ResultFile::readHeader(const std::string& path)
+{
+    std::unique_ptr <std::FILE, int (*)(std::FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+    if (file == nullptr)
+        throw std::runtime_error("Cannot open file " + path);
+
+    return readHeader(file.get(), path);
+}
+
+ResultHeader ResultFile::readHeader(std::FILE* file, const std::string& path)
+{
+    unsigned char header[m_headerSize] {};
+
+    if (std::fread(header, 1, m_headerSize, file) != m_headerSize ||
+        header[0] != 'C' || header[1] != 'L' || header[2] != 'R' || header[3] != 'S' ||
+        getInteger(header + 4, 4) != m_version || getInteger(header + 8, 4) != m_recordSize)
+    {
+        throw std::runtime_error("Not a result file " + path);
+    }
+
+    const auto nameBegin = reinterpret_cast <const char*>(header + m_policyNameOffset);
+    const auto nameEnd = std::find(nameBegin, nameBegin + (m_headerSize - m_policyNameOffset), '\0');
+
+    return ResultHeader {static_cast <std::int32_t>(getInteger(header + 12, 4)),
+                         getInteger(header + 16, 8),
+                         static_cast <std::int32_t>(getInteger(header + 24, 4)),
+                         static_cast <std::int32_t>(getInteger(header + 28, 4)),
+                         static_cast <std::int32_t>(getInteger(header + 32, 4)),
+                         static_cast <std::int32_t>(getInteger(header + 36, 4)),
+                         static_cast <std::int32_t>(getInteger(header + 40, 4)),
+                         getInteger(header + 48, 8),
+                         std::string(nameBegin, nameEnd)};
+}
+
+/*
+ * A batch stopped in the middle leaves the file shorter or with gaps of zeros
+ */
+std::vector <GameRecord> ResultFile::read(const std::string& path, const ResultHeader& settings)
+{
+    std::unique_ptr <std::FILE, int (*)(std::FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+    if (file == nullptr)
+        throw std::runtime_error("Cannot open file " + path);
+
+    const auto written = readHeader(file.get(), path);
+
+    const std::pair <bool, const char*> differences[] {
+        {written.gameCount != settings.gameCount, "number of games"},
+        {written.masterSeed != settings.masterSeed, "seed"},
+        {written.widthInTiles != settings.widthInTiles || written.heightInTiles != settings.heightInTiles, "board size"},
+        {written.colorCount != settings.colorCount, "number of colors"},
+        {written.maxMoveCount != settings.maxMoveCount, "maximal number of moves"},
+        {written.randomAlgorithm != settings.randomAlgorithm, "generator"},
+        {written.startPositionHash != settings.startPositionHash, "start position"},
+        {written.policyName != settings.policyName, "policy"}
+    };
+
+    for (const auto& difference : differences)
+    {
+        if (difference.first)
+            throw std::runtime_error("The results in " + path + " are of another " + difference.second);
+    }
+
+    const auto gameCount = settings.gameCount;
+
+    std::vector <unsigned char> buffer(static_cast <size_t>(gameCount) * m_recordSize);
+    const auto size = std::fread(buffer.data(), 1, buffer.size(), file.get());
+
+    std::vector <GameRecord> records(gameCount, GameRecord {0, 0, 0});
+
+    for (size_t i = 0; i < size / m_recordSize; i++)
+    {
+        const auto data = buffer.data() + i * m_recordSize;
+        records[i].seed = getInteger(data, 8);
+        records[i].score = static_cast <std::int32_t>(getInteger(data + 8, 4));
+        records[i].moveCount = static_cast <std::int32_t>(getInteger(data + 12, 4));
+    }
+
+    return records;
+}
+
+/*
+ * The file is little-endian on any platform
+ */
+void ResultFile::putInteger(unsigned char* data, const std::uint64_t value, const int byteCount)
+{
+    for (auto i = 0; i < byteCount; i++)
+        data[i] = static_cast <unsigned char>(value >> (8 * i));
+}
+
+std::uint64_t ResultFile::getInteger(const unsigned char* data, const int byteCount)
+{
+    std::uint64_t value = 0;
+
+    for (auto i = 0; i < byteCount; i++)
+        value |= static_cast <std::uint64_t>(data[i]) << (8 * i);
+
+    return value;
+}
@@ -0,0 +1,112 @@
+#include "SimulationStatistics.hpp"
+
+SimulationStatistics::SimulationStatistics() : m_moveCount(0), m_isSorted(true)
+{
+    //ctor
+}
+
+SimulationStatistics::~SimulationStatistics()
+{
+    //dtor
+}
+
+void SimulationStatistics::add(const GameResult& result)
+{
+    m_scores.push_back(result.score);
+    m_moveCount += result.moveCount;
+    m_isSorted = false;
+}
+
+void SimulationStatistics::merge(const SimulationStatistics& other)
+{
+    m_scores.insert(m_scores.end(), other.m_scores.begin(), other.m_scores.end());
+    m_moveCount += other.m_moveCount;
+    m_isSorted = false;
+}
+
+int SimulationStatistics::getGameCount() const
+{
+    return static_cast <int>(m_scores.size());
+}
+
+std::int64_t SimulationStatistics::getMoveCount() const
+{
+    return m_moveCount;
+}
+
+int SimulationStatistics::getMinScore() const
+{
+    if (m_scores.empty())
+        return 0;
+
+    return *std::min_element(m_scores.begin(), m_scores.end());
+}
+
+int SimulationStatistics::getMaxScore() const
+{
+    if (m_scores.empty())
+        return 0;
+
+    return *std::max_element(m_scores.begin(), m_scores.end());
+}
+
+double SimulationStatistics::getMeanScore() const
+{
+    if (m_scores.empty())
+        return 0.0;
+
+    auto sum = 0.0;
+    for (const auto score : m_scores)
+        sum += score;
+
+    return sum / m_scores.size();
+}
+
+double SimulationStatistics::getScoreDeviation() const
+{
+    if (m_scores.empty())
+        return 0.0;
+
+    const auto mean = getMeanScore();
+
+    auto sum = 0.0;
+    for (const auto score : m_scores)
+        sum += (score - mean) * (score - mean);
+
+    return std::sqrt(sum / m_scores.size());
+}
+
+int SimulationStatistics::getScorePercentile(const double fraction)
+{
+    if (m_scores.empty())
+        return 0;
+
+    // Scores are sorted once, after all the games are added
+    if (!m_isSorted)
+    {
+        std::sort(m_scores.begin(), m_scores.end());
+        m_isSorted = true;
+    }
+
+    auto index = static_cast <int>(std::ceil(fraction * m_scores.size())) - 1;
+    index = std::clamp(index, 0, static_cast <int>(m_scores.size()) - 1);
+
+    return m_scores[index];
+}
+
+std::vector <int> SimulationStatistics::getScoreHistogram(const int bucketCount, int& width) const
+{
+    std::vector <int> histogram(bucketCount, 0);
+
+    width = 1;
+    if (m_scores.empty() || bucketCount <= 0)
+        return histogram;
+
+    const auto min = getMinScore();
+    width = (getMaxScore() - min) / bucketCount + 1;
+
+    for (const auto score : m_scores)
+        histogram[(score - min) / width]++;
+
+    return histogram;
+}
@@ -0,0 +1,36 @@
+#include "Simulator.hpp"
+
+Simulator::Simulator(MovePolicy& policy) : m_policy(policy)
+{
+    //ctor
+}
+
+Simulator::~Simulator()
+{
+    //dtor
+}
+
+GameResult Simulator::playGame(GameEngine& game,
+                               const int widthInTiles,
+                               const int heightInTiles,
+                               const int colorCount,
+                               const int maxMoveCount)
+{
+    game.startNewGame(widthInTiles, heightInTiles, colorCount);
+    return continueGame(game, maxMoveCount);
+}
+
+GameResult Simulator::continueGame(GameEngine& game, const int maxMoveCount)
+{
+    GameResult result {0, 0};
+    Move move;
+
+    while (!game.isGameOver() && result.moveCount < maxMoveCount && m_policy.chooseMove(game, move))
+    {
+        game.applyMove(move);
+        result.moveCount++;
+    }
+
+    result.score = game.getScore();
+    return result;
+}
@@ -0,0 +1,215 @@
+#include "SnapshotFile.hpp"
+
+#include <memory>
+#include <cstdio>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+SnapshotFile::SnapshotFile(const std::string& path) :
+    m_path(path),
+    m_temporaryPath(path + ".tmp"),
+    m_isWaiting(false),
+    m_isWriting(false),
+    m_isRunning(false),
+    m_isWriteFailed(false)
+{
+    //ctor
+}
+
+SnapshotFile::~SnapshotFile()
+{
+    if (!m_thread.joinable())
+        return;
+
+    {
+        std::lock_guard <std::mutex> lock(m_mutex);
+        m_isRunning = false;
+    }
+
+    m_condition.notify_all();
+    m_thread.join();
+}
+
+/*
+ * The buffer keeps its capacity, so saving after every move does not allocate
+ */
+void SnapshotFile::save(const GameEngine& game)
+{
+    m_buffer.resize(game.getSnapshotSize());
+    game.save(m_buffer);
+
+    writeTemporaryFile(m_buffer);
+}
+
+bool SnapshotFile::saveInBackground(const GameEngine& game)
+{
+    auto isWriteFailed = false;
+
+    {
+        std::lock_guard <std::mutex> lock(m_mutex);
+
+        m_waitingBuffer.resize(game.getSnapshotSize());
+        game.save(m_waitingBuffer);
+        m_isWaiting = true;
+
+        std::swap(isWriteFailed, m_isWriteFailed);
+
+        if (!m_isRunning)
+        {
+            m_isRunning = true;
+            m_thread = std::thread(&SnapshotFile::run, this);
+        }
+    }
+
+    m_condition.notify_all();
+    return !isWriteFailed;
+}
+
+bool SnapshotFile::waitForBackgroundSaves()
+{
+    std::unique_lock <std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]() { return !m_isWaiting && !m_isWriting; });
+
+    auto isWriteFailed = false;
+    std::swap(isWriteFailed, m_isWriteFailed);
+
+    return !isWriteFailed;
+}
+
+bool SnapshotFile::load(GameEngine& game)
+{
+    if (read().empty())
+        return false;
+
+    game.load(m_buffer);
+    return true;
+}
+
+const std::vector <unsigned char>& SnapshotFile::read()
+{
+    m_buffer.clear();
+
+    std::unique_ptr <std::FILE, int (*)(std::FILE*)> file(std::fopen(m_path.c_str(), "rb"), &std::fclose);
+    if (file == nullptr)
+        return m_buffer;
+
+    if (std::fseek(file.get(), 0, SEEK_END) != 0)
+        throw std::runtime_error("Cannot read file " + m_path);
+
+    const auto size = std::ftell(file.get());
+    if (size < 0 || std::fseek(file.get(), 0, SEEK_SET) != 0)
+        throw std::runtime_error("Cannot read file " + m_path);
+
+    m_buffer.resize(static_cast <size_t>(size));
+
+    if (std::fread(m_buffer.data(), 1, m_buffer.size(), file.get()) != m_buffer.size())
+        throw std::runtime_error("Cannot read file " + m_path);
+
+    return m_buffer;
+}
+
+/*
+ * The waiting snapshot is written even after the stop, so the last save before the exit is not lost
+ */
+void SnapshotFile::run()
+{
+    std::unique_lock <std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        m_condition.wait(lock, [this]() { return m_isWaiting || !m_isRunning; });
+
+        if (!m_isWaiting)
+            return;
+
+        std::swap(m_waitingBuffer, m_writtenBuffer);
+        m_isWaiting = false;
+        m_isWriting = true;
+        lock.unlock();
+
+        auto isWriteFailed = false;
+
+        try
+        {
+            writeTemporaryFile(m_writtenBuffer);
+        }
+        catch (const std::runtime_error&)
+        {
+            isWriteFailed = true;
+        }
+
+        lock.lock();
+        m_isWriting = false;
+        m_isWriteFailed = m_isWriteFailed || isWriteFailed;
+        m_condition.notify_all();
+    }
+}
+
+#ifdef _WIN32
+
+void SnapshotFile::writeTemporaryFile(const std::vector <unsigned char>& buffer)
+{
+    const auto file = CreateFileA(m_temporaryPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Cannot create file " + m_temporaryPath);
+
+    DWORD written = 0;
+    const auto isWriteSuccessful = WriteFile(file, buffer.data(), static_cast <DWORD>(buffer.size()), &written, nullptr) &&
+                                   written == buffer.size() &&
+                                   FlushFileBuffers(file);
+    CloseHandle(file);
+
+    if (!isWriteSuccessful)
+        throw std::runtime_error("Cannot write file " + m_temporaryPath);
+
+    if (!MoveFileExA(m_temporaryPath.c_str(), m_path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        throw std::runtime_error("Cannot replace file " + m_path);
+}
+
+#else
+
+/*
+ * The directory is flushed too, otherwise the rename itself may be lost
+ */
+void SnapshotFile::writeTemporaryFile(const std::vector <unsigned char>& buffer)
+{
+    const auto file = open(m_temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0)
+        throw std::runtime_error("Cannot create file " + m_temporaryPath);
+
+    size_t offset = 0;
+    while (offset < buffer.size())
+    {
+        const auto written = ::write(file, buffer.data() + offset, buffer.size() - offset);
+        if (written <= 0)
+            break;
+
+        offset += static_cast <size_t>(written);
+    }
+
+    const auto isWriteSuccessful = (offset == buffer.size() && fsync(file) == 0);
+
+    if (close(file) != 0 || !isWriteSuccessful)
+        throw std::runtime_error("Cannot write file " + m_temporaryPath);
+
+    if (std::rename(m_temporaryPath.c_str(), m_path.c_str()) != 0)
+        throw std::runtime_error("Cannot replace file " + m_path);
+
+    const auto separator = m_path.find_last_of('/');
+    const auto directoryPath = (separator == std::string::npos) ? std::string(".") : m_path.substr(0, separator + 1);
+
+    const auto directory = open(directoryPath.c_str(), O_RDONLY);
+    if (directory >= 0)
+    {
+        fsync(directory);
+        close(directory);
+    }
+}
+
+#endif
@@ -0,0 +1,111 @@
+#include "TileMapVertices.hpp"
+
+namespace
+{
+    // A quad of the cell and a quad of the ball above it
+    const int maxVertexCountPerTile = 2 * 4;
+}
+
+TileMapVertices::TileMapVertices(GameEngine& game, const TextureRects& textureRects, const int spriteSize) :
+    m_game(game),
+    m_textureRects(textureRects),
+    m_spriteSize(spriteSize)
+{
+    //ctor
+}
+
+TileMapVertices::~TileMapVertices()
+{
+    //dtor
+}
+
+void TileMapVertices::update(const TileRectangle& visibleChunks)
+{
+    const auto chunkCountInRow = m_game.getChunkCountInRow();
+
+    // Chunks out of sight are dropped first, so only the changed chunks in sight are built again
+    for (auto i = m_chunks.begin(); i != m_chunks.end();)
+    {
+        const auto row = i->first / chunkCountInRow;
+        const auto column = i->first % chunkCountInRow;
+
+        if (row < visibleChunks.top || row >= visibleChunks.bottom || column < visibleChunks.left || column >= visibleChunks.right)
+            i = m_chunks.erase(i);
+        else
+            ++i;
+    }
+
+    for (const auto chunk : m_game.getDirtyChunks())
+    {
+        const auto found = m_chunks.find(chunk);
+        if (found != m_chunks.end())
+            buildChunk(m_game.getChunkRectangle(chunk), found->second);
+    }
+
+    m_game.clearDirtyRegion();
+
+    // A chunk coming into sight is built for the first time
+    // The array is resized to its greatest size and cleared, which keeps the memory for later builds
+    for (auto row = visibleChunks.top; row < visibleChunks.bottom; row++)
+    {
+        for (auto column = visibleChunks.left; column < visibleChunks.right; column++)
+        {
+            const auto chunk = row * chunkCountInRow + column;
+            if (m_chunks.find(chunk) != m_chunks.end())
+                continue;
+
+            const auto rectangle = m_game.getChunkRectangle(chunk);
+            auto& vertices = m_chunks.emplace(chunk, sf::VertexArray(sf::Quads)).first->second;
+
+            vertices.resize(static_cast <std::size_t>(rectangle.bottom - rectangle.top) *
+                            (rectangle.right - rectangle.left) * maxVertexCountPerTile);
+            buildChunk(rectangle, vertices);
+        }
+    }
+}
+
+const sf::VertexArray& TileMapVertices::getChunk(const int chunk) const
+{
+    return m_chunks.at(chunk);
+}
+
+/*
+ * Every cell of the chunk gets a quad, and every ball gets another one above it
+ */
+void TileMapVertices::buildChunk(const TileRectangle& chunk, sf::VertexArray& vertices)
+{
+    const auto& tileMap = m_game.getTileMap();
+
+    vertices.clear();
+
+    for (auto i = chunk.top; i < chunk.bottom; i++)
+    {
+        const auto row = tileMap.getRow(i);
+
+        for (auto j = chunk.left; j < chunk.right; j++)
+        {
+            sf::Vector2f position(j * m_spriteSize, i * m_spriteSize);
+
+            appendTileQuad(vertices, position, Tile::Empty);
+
+            if (row[j] != Tile::Empty)
+                appendTileQuad(vertices, position, row[j]);
+        }
+    }
+}
+
+void TileMapVertices::appendTileQuad(sf::VertexArray& vertices, const sf::Vector2f& position, const Tile tile)
+{
+    const auto size = static_cast <float>(m_spriteSize);
+    const auto& rect = m_textureRects[static_cast <int>(tile)];
+
+    // Corners go clockwise from the top left one, both on the screen and in the atlas
+    const sf::Vector2f topLeft(rect.left, rect.top);
+    const sf::Vector2f width(rect.width, 0);
+    const sf::Vector2f height(0, rect.height);
+
+    vertices.append(sf::Vertex(position, topLeft));
+    vertices.append(sf::Vertex(position + sf::Vector2f(size, 0), topLeft + width));
+    vertices.append(sf::Vertex(position + sf::Vector2f(size, size), topLeft + width + height));
+    vertices.append(sf::Vertex(position + sf::Vector2f(0, size), topLeft + height));
+}
@@ -0,0 +1,60 @@
+#include "TranspositionTable.hpp"
+
+TranspositionTable::TranspositionTable() : m_mask(0)
+{
+    //ctor
+}
+
+TranspositionTable::~TranspositionTable()
+{
+    //dtor
+}
+
+void TranspositionTable::resize(const std::size_t sizeInBytes)
+{
+    std::size_t slotCount = 1;
+    while (slotCount * 2 * sizeof(Slot) <= sizeInBytes)
+        slotCount *= 2;
+
+    m_slots = std::make_unique <Slot[]>(slotCount);
+    m_mask = slotCount - 1;
+
+    clear();
+}
+
+/*
+ * Must not be called while other threads use the table
+ */
+void TranspositionTable::clear()
+{
+    for (std::size_t i = 0; i <= m_mask && m_slots; i++)
+    {
+        m_slots[i].check.store(0, std::memory_order_relaxed);
+        m_slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::size_t TranspositionTable::getSlotCount() const
+{
+    return m_slots ? m_mask + 1 : 0;
+}
+
+/*
+ * A deeper search gives a better value, so it is kept even if another position wants the slot
+ */
+void TranspositionTable::store(const std::uint64_t key, const Entry& entry)
+{
+    if (!m_slots)
+        return;
+
+    auto& slot = m_slots[key & m_mask];
+    const auto oldData = slot.data.load(std::memory_order_relaxed);
+    const auto oldCheck = slot.check.load(std::memory_order_relaxed);
+
+    if (oldData != 0 && (oldCheck ^ oldData) != key && unpack(oldData).depth > entry.depth)
+        return;
+
+    const auto data = pack(entry);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
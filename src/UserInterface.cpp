@@ -1,18 +1,59 @@
 #include "UserInterface.hpp"
 
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+    // Bigger tilemaps are scrolled, the window never grows beyond this number of tiles on a side
+    const int maxVisibleTileCount = 16;
+
+    // The view zooms out to the whole tilemap or to this number of tiles across, whichever is less,
+    // so a frame never draws more than a few dozens of chunks
+    const int maxZoomedOutTileCount = 128;
+    const int minZoomedInTileCount = 4;
+    const float zoomStep = 1.25f;
+
+    // The search needs every move of the position, which huge tilemaps have too many of
+    const int maxHintCellCount = 64 * 64;
+
+    // A ball rolls through a cell of its path in this time, but a long path is rolled faster to end in the longest time
+    const float moveStepSeconds = 0.04f;
+    const float maxMoveSeconds = 0.5f;
+
+    // A frame longer than this is a visible stall
+    const std::uint32_t stallFrameMicroseconds = 100000;
+}
+
 UserInterface::UserInterface(GameEngine& game, const ResourceManager& resourceManager) :
     m_game(game),
     m_resourceManager(resourceManager),
-    m_window(sf::VideoMode(resourceManager.getSpriteSize() * game.getTileMapWidth(),
-                           resourceManager.getSpriteSize() * (game.getTileMapHeight() + 1)),
+    m_window(sf::VideoMode(resourceManager.getSpriteSize() * std::min(game.getTileMapWidth(), maxVisibleTileCount),
+                           resourceManager.getSpriteSize() * (std::min(game.getTileMapHeight(), maxVisibleTileCount) + 1)),
              "Lines",
              sf::Style::Close),
     m_elapsedSeconds(0.0f),
     m_maxClockDelayInSeconds(1.0f),
-    m_infoPanel(sf::Vector2f(m_resourceManager.getSpriteSize() * game.getTileMapWidth(),
-                             m_resourceManager.getSpriteSize())),
+    m_infoPanel(sf::Vector2f(m_window.getSize().x, m_resourceManager.getSpriteSize())),
     m_textColor(0x35, 0xC5, 0xFF),
-    m_font(m_resourceManager.getFont())
+    m_tileMapVertices(game, resourceManager.getTextureRects(), resourceManager.getSpriteSize()),
+    m_hint {0, 0, 0, 0},
+    m_hintHash(0),
+    m_isHintAvailable(false),
+    m_isBallMoving(false),
+    m_moveDurationInSeconds(0.0f),
+    m_isRedrawNeeded(true),
+    m_renderedScore(-1),
+    m_renderedTime(-1),
+    m_isGameOverRendered(false),
+    m_idleFrameTime(sf::seconds(1.0f / 30)),
+    m_drawCallCount(0),
+    m_isOverlayVisible(false),
+    m_overlayRefreshTime(sf::seconds(0.5f)),
+    m_traceFilePath("frames.csv"),
+    m_logger(nullptr),
+    m_autosave(nullptr),
+    m_savedPositionVersion(game.getPositionVersion())
 {
     m_window.setFramerateLimit(30);
     m_window.setVerticalSyncEnabled(true);
@@ -21,30 +62,83 @@ UserInterface::UserInterface(GameEngine& game, const ResourceManager& resourceMa
 
     m_scoreText.setFillColor(m_textColor);
     m_scoreText.setCharacterSize(m_infoPanel.getSize().y / 2);
-    m_scoreText.setFont(m_font);
+    m_scoreText.setFont(m_resourceManager.getFont());
 
     m_timeText.setFillColor(m_textColor);
     m_timeText.setCharacterSize(m_infoPanel.getSize().y / 2);
-    m_timeText.setFont(m_font);
+    m_timeText.setFont(m_resourceManager.getFont());
 
     m_gameOverPanel.setFillColor(sf::Color(0, 0, 0, 192));
 
     m_gameOverText.setFillColor(m_textColor);
     m_gameOverText.setCharacterSize(m_infoPanel.getSize().y / 2);
-    m_gameOverText.setFont(m_font);
+    m_gameOverText.setFont(m_resourceManager.getFont());
     m_gameOverText.setString("GAME OVER");
+
+    // The view takes the part of the window below the info panel
+    const auto spriteSize = m_resourceManager.getSpriteSize();
+    const auto tileMapTop = m_infoPanel.getSize().y / m_window.getSize().y;
+
+    m_boardView.setViewport(sf::FloatRect(0, tileMapTop, 1, 1 - tileMapTop));
+    m_minViewWidth = minZoomedInTileCount * spriteSize;
+    m_maxViewWidth = std::min(game.getTileMapWidth(), maxZoomedOutTileCount) * spriteSize;
+    resetBoardView();
+
+    // The search must not stop the window for long
+    m_hintPolicy.setTimeBudget(std::chrono::milliseconds(300));
+    m_hintPolicy.setMaxDepth(8);
+
+    const float hintThickness = 3;
+    m_hintFrame.setSize(sf::Vector2f(spriteSize - 2 * hintThickness, spriteSize - 2 * hintThickness));
+    m_hintFrame.setOrigin(-hintThickness, -hintThickness);
+    m_hintFrame.setFillColor(sf::Color::Transparent);
+    m_hintFrame.setOutlineColor(m_textColor);
+    m_hintFrame.setOutlineThickness(hintThickness);
+
+    m_vacatedCell.setTexture(m_resourceManager.getAtlasTexture());
+    m_vacatedCell.setTextureRect(m_resourceManager.getTextureRect(Tile::Empty));
+    m_movingBall.setTexture(m_resourceManager.getAtlasTexture());
+
+    m_overlayPanel.setFillColor(sf::Color(0, 0, 0, 192));
+    m_overlayPanel.setPosition(0, m_infoPanel.getSize().y);
+
+    m_overlayText.setFillColor(m_textColor);
+    m_overlayText.setCharacterSize(spriteSize / 4);
+    m_overlayText.setFont(m_resourceManager.getFont());
+    m_overlayText.setPosition(m_overlayPanel.getPosition() + sf::Vector2f(hintThickness, hintThickness));
 }
 
 UserInterface::~UserInterface()
 {
-    //dtor
+    if (m_traceThread.joinable())
+        m_traceThread.join();
+}
+
+void UserInterface::setLogger(Logger* logger)
+{
+    m_logger = logger;
+}
+
+void UserInterface::setAutosave(SnapshotFile* autosave)
+{
+    m_autosave = autosave;
+}
+
+void UserInterface::setFrameTracePath(const std::string& path)
+{
+    m_traceFilePath = path;
 }
 
 void UserInterface::startMainLoop()
 {
     while (m_window.isOpen())
     {
+        m_profiler.beginFrame();
+        m_drawCallCount = 0;
+
         processTimer();
+        m_profiler.endPhase(FramePhase::Timer);
+
         sf::Event event;
 
         while (m_window.pollEvent(event))
@@ -52,14 +146,89 @@ void UserInterface::startMainLoop()
             if (event.type == sf::Event::MouseButtonPressed)
                 processClick();
 
+            if (event.type == sf::Event::KeyPressed)
+                processKeyPress(event.key);
+
+            if (event.type == sf::Event::MouseWheelScrolled && event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel)
+                zoomBoardView(event.mouseWheelScroll.delta > 0 ? 1 / zoomStep : zoomStep);
+
             if (event.type == sf::Event::Closed)
                 m_window.close();
+
+            // The contents of the window may have been lost
+            if (event.type == sf::Event::GainedFocus || event.type == sf::Event::Resized)
+                m_isRedrawNeeded = true;
+        }
+
+        // The move is made as soon as the ball has rolled to the destination, so it is saved at once below
+        if (m_isBallMoving)
+            processBallMove();
+
+        // A crash loses at most the time since the last move, the picks alone are not saved
+        if (m_autosave != nullptr && m_game.getPositionVersion() != m_savedPositionVersion)
+            saveGame();
+
+        m_profiler.endPhase(FramePhase::Events);
+
+        // A frame without changes is not presented at all,
+        // the loop just waits for the next input or timer tick
+        // The waiting is not a part of the frame
+        const auto isRedrawn = isRedrawNeeded();
+        if (isRedrawn)
+            renderGame();
+
+        m_profiler.endFrame(m_drawCallCount);
+
+        const auto frameMicroseconds = m_profiler.getLastFrameMicroseconds();
+        if (m_logger != nullptr && frameMicroseconds > stallFrameMicroseconds)
+        {
+            m_logger->write(LogLevel::Warning, LogEvent::FrameStall,
+                            {static_cast <std::int32_t>(frameMicroseconds), m_drawCallCount, 0, 0, 0});
         }
 
-        renderGame();
+        if (!isRedrawn)
+            sf::sleep(m_idleFrameTime);
+    }
+
+    // The last save is waited for, so its failure is logged too
+    if (m_autosave != nullptr)
+    {
+        saveGame();
+
+        if (!m_autosave->waitForBackgroundSaves() && m_logger != nullptr)
+            m_logger->write(LogLevel::Warning, LogEvent::AutosaveFailed, {0, 0, 0, 0, 0});
     }
 }
 
+/*
+ * The snapshot is written on the thread of the file, a failed write is told by a later save
+ * A failed save must not end the game, the next move tries again
+ */
+void UserInterface::saveGame()
+{
+    m_savedPositionVersion = m_game.getPositionVersion();
+
+    if (!m_autosave->saveInBackground(m_game) && m_logger != nullptr)
+        m_logger->write(LogLevel::Warning, LogEvent::AutosaveFailed, {0, 0, 0, 0, 0});
+}
+
+bool UserInterface::isRedrawNeeded() const
+{
+    return (m_isRedrawNeeded ||
+            m_isBallMoving ||
+            !m_game.getDirtyRegion().isEmpty() ||
+            m_game.getScore() != m_renderedScore ||
+            m_game.getTimeInSeconds() != m_renderedTime ||
+            m_game.isGameOver() != m_isGameOverRendered ||
+            (m_isOverlayVisible && m_overlayClock.getElapsedTime() >= m_overlayRefreshTime));
+}
+
+void UserInterface::draw(sf::RenderTarget& target, const sf::Drawable& drawable, const sf::RenderStates& states)
+{
+    target.draw(drawable, states);
+    m_drawCallCount++;
+}
+
 void UserInterface::processTimer()
 {
     m_elapsedSeconds += m_clock.restart().asSeconds();
@@ -73,19 +242,29 @@ void UserInterface::processTimer()
 
 void UserInterface::processClick()
 {
+    // A click while the ball rolls only makes the move at once
+    if (m_isBallMoving)
+    {
+        finishBallMove();
+        return;
+    }
+
     const auto position = sf::Mouse::getPosition(m_window);
     const auto tileMapTop = m_infoPanel.getLocalBounds().height + m_infoPanel.getLocalBounds().top;
     const auto spriteSize = m_resourceManager.getSpriteSize();
 
     // We process click by calculating selected row and column except for:
     // 1. When the game is over, so we just restart it after clicking anywhere
-    // 2. When clicked at the top panel
+    // 2. When clicked at the top panel, which restarts the game too
+    // 3. When clicked beside the tilemap, which a zoomed out view may show
     if (!m_game.isGameOver() && position.y >= tileMapTop)
     {
-        const auto row = (position.y - tileMapTop) / spriteSize;
-        const auto column = position.x / spriteSize;
+        const auto point = m_window.mapPixelToCoords(position, m_boardView);
+        const auto row = static_cast <int>(std::floor(point.y / spriteSize));
+        const auto column = static_cast <int>(std::floor(point.x / spriteSize));
 
-        m_game.processPick(row, column);
+        if (row >= 0 && row < m_game.getTileMapHeight() && column >= 0 && column < m_game.getTileMapWidth())
+            pickTile(row, column);
     }
     else
     {
@@ -96,77 +275,319 @@ void UserInterface::processClick()
     }
 }
 
+/*
+ * A pick that moves the selected ball starts it rolling along the path, every other pick is processed at once
+ */
+void UserInterface::pickTile(const int row, const int column)
+{
+    const auto selection = m_game.getSelection();
+
+    if (selection.first < 0 || !m_game.findPath(Move {selection.first, selection.second, row, column}, m_movePath))
+    {
+        m_game.processPick(row, column);
+        return;
+    }
+
+    const auto ball = selectedToNormal(m_game.getTileMap().get(selection.first, selection.second));
+    m_movingBall.setTextureRect(m_resourceManager.getTextureRect(ball));
+
+    const auto stepCount = static_cast <float>(m_movePath.size() - 1);
+    m_moveDurationInSeconds = std::min(stepCount * moveStepSeconds, maxMoveSeconds);
+    m_moveClock.restart();
+    m_isBallMoving = true;
+}
+
+void UserInterface::processBallMove()
+{
+    if (m_moveClock.getElapsedTime().asSeconds() >= m_moveDurationInSeconds)
+        finishBallMove();
+}
+
+/*
+ * The second pick is made only now, the path of the ball is still free, as nothing else changes the tilemap meanwhile
+ */
+void UserInterface::finishBallMove()
+{
+    const auto& destination = m_movePath.back();
+
+    m_isBallMoving = false;
+    m_isRedrawNeeded = true;
+    m_game.processPick(destination.first, destination.second);
+}
+
+void UserInterface::processKeyPress(const sf::Event::KeyEvent& key)
+{
+    // The keys that change the game or search it make the move of the rolling ball first
+    if (m_isBallMoving && (key.code == sf::Keyboard::H || key.control))
+        finishBallMove();
+
+    if (key.code == sf::Keyboard::H && !key.control)
+        findHint();
+
+    if (key.code == sf::Keyboard::F3)
+    {
+        m_isOverlayVisible = !m_isOverlayVisible;
+        m_overlayClock.restart();
+        updateOverlayText();
+        m_isRedrawNeeded = true;
+    }
+
+    if (key.code == sf::Keyboard::F4)
+        writeFrameTrace();
+
+    // Arrows scroll the tilemap by a quarter of the view
+    const auto viewSize = m_boardView.getSize();
+
+    if (key.code == sf::Keyboard::Left)
+        scrollBoardView(-viewSize.x / 4, 0);
+    else if (key.code == sf::Keyboard::Right)
+        scrollBoardView(viewSize.x / 4, 0);
+    else if (key.code == sf::Keyboard::Up)
+        scrollBoardView(0, -viewSize.y / 4);
+    else if (key.code == sf::Keyboard::Down)
+        scrollBoardView(0, viewSize.y / 4);
+
+    if (!key.control)
+        return;
+
+    if (key.code == sf::Keyboard::Z)
+        m_game.undo();
+    else if (key.code == sf::Keyboard::Y)
+        m_game.redo();
+}
+
+/*
+ * The view never leaves the tilemap, and a view bigger than the tilemap keeps it in the center
+ */
+void UserInterface::scrollBoardView(const float x, const float y)
+{
+    const auto spriteSize = static_cast <float>(m_resourceManager.getSpriteSize());
+    const sf::Vector2f tileMapSize(m_game.getTileMapWidth() * spriteSize, m_game.getTileMapHeight() * spriteSize);
+    const auto halfSize = m_boardView.getSize() / 2.0f;
+
+    auto center = m_boardView.getCenter() + sf::Vector2f(x, y);
+
+    center.x = (halfSize.x * 2 >= tileMapSize.x) ? tileMapSize.x / 2 : std::clamp(center.x, halfSize.x, tileMapSize.x - halfSize.x);
+    center.y = (halfSize.y * 2 >= tileMapSize.y) ? tileMapSize.y / 2 : std::clamp(center.y, halfSize.y, tileMapSize.y - halfSize.y);
+
+    m_boardView.setCenter(center);
+    m_isRedrawNeeded = true;
+}
+
+/*
+ * Zooms around the center of the view, the shape of the view stays the same
+ */
+void UserInterface::zoomBoardView(const float factor)
+{
+    const auto size = m_boardView.getSize();
+    const auto width = std::clamp(size.x * factor, m_minViewWidth, m_maxViewWidth);
+
+    m_boardView.setSize(size * (width / size.x));
+    scrollBoardView(0, 0);
+}
+
+/*
+ * The view starts at the top left corner of the tilemap, one pixel of the window per pixel of the tiles
+ */
+void UserInterface::resetBoardView()
+{
+    const sf::Vector2f size(m_window.getSize().x, m_window.getSize().y - m_infoPanel.getSize().y);
+
+    m_boardView.setSize(size);
+    m_boardView.setCenter(size / 2.0f);
+    scrollBoardView(0, 0);
+}
+
+void UserInterface::findHint()
+{
+    if (m_game.isGameOver() || m_game.getTileMapWidth() * m_game.getTileMapHeight() > maxHintCellCount)
+        return;
+
+    SearchResult result;
+    if (!m_hintPolicy.search(m_game, result))
+        return;
+
+    m_hint = result.bestMove;
+    m_hintHash = m_game.getHash();
+    m_isHintAvailable = true;
+    m_isRedrawNeeded = true;
+}
+
+/*
+ * The frames are written while the game goes on, the profiler does not wait for the writer
+ * A failed writing is not worth stopping the game for
+ */
+void UserInterface::writeFrameTrace()
+{
+    if (m_traceThread.joinable())
+        m_traceThread.join();
+
+    m_traceThread = std::thread([this]()
+    {
+        try
+        {
+            m_profiler.writeCsv(m_traceFilePath);
+        }
+        catch (const std::exception&)
+        {
+        }
+    });
+}
+
 void UserInterface::renderGame()
 {
+    // Clearing is counted with the info panel, which is drawn first
     m_window.clear();
 
     renderInfoPanel();
+    m_profiler.endPhase(FramePhase::InfoPanel);
+
     renderTileMap();
+    renderMovingBall();
+    m_profiler.endPhase(FramePhase::TileMap);
+
+    renderHint();
+    m_profiler.endPhase(FramePhase::Hint);
 
     if (m_game.isGameOver())
         renderGameOverPanel();
+    m_profiler.endPhase(FramePhase::GameOverPanel);
+
+    renderOverlay();
+    m_profiler.endPhase(FramePhase::Overlay);
 
     m_window.display();
+    m_profiler.endPhase(FramePhase::Display);
+
+    m_isRedrawNeeded = false;
+    m_isGameOverRendered = m_game.isGameOver();
 }
 
 void UserInterface::renderInfoPanel()
 {
-    m_window.draw(m_infoPanel);
+    draw(m_window, m_infoPanel);
 
     const float margin = 10;
-    std::ostringstream oss;
 
     // Scores are drawn in the top right angle
     // and centered vertically
+    // Texts are laid out again only when their values change
     const auto score = m_game.getScore();
-    oss << std::setfill('0') << std::setw(7) << score;
-    m_scoreText.setString(oss.str());
+    if (score != m_renderedScore)
+    {
+        std::snprintf(m_textBuffer.data(), m_textBuffer.size(), "%07d", score);
+        m_scoreText.setString(m_textBuffer.data());
+        m_renderedScore = score;
+    }
 
     auto x = m_infoPanel.getLocalBounds().width + m_infoPanel.getLocalBounds().left - m_scoreText.getLocalBounds().width - m_scoreText.getLocalBounds().left - margin;
     auto y = (m_infoPanel.getLocalBounds().height + m_infoPanel.getLocalBounds().top - m_scoreText.getLocalBounds().height - m_scoreText.getLocalBounds().top) / 2;
     m_scoreText.setPosition(x, y);
-    m_window.draw(m_scoreText);
-
-    oss.str(std::string());
+    draw(m_window, m_scoreText);
 
     // Time is drawn in the top left angle
     // and centered vertically
     const auto seconds = m_game.getTimeInSeconds();
-    oss << seconds / (60 * 60) << ':'
-        << std::setfill('0') << std::setw(2) << (seconds / 60) % 60 << ':'
-        << std::setfill('0') << std::setw(2) << seconds % 60;
-    m_timeText.setString(oss.str());
+    if (seconds != m_renderedTime)
+    {
+        std::snprintf(m_textBuffer.data(), m_textBuffer.size(), "%d:%02d:%02d",
+                      seconds / (60 * 60), (seconds / 60) % 60, seconds % 60);
+        m_timeText.setString(m_textBuffer.data());
+        m_renderedTime = seconds;
+    }
 
     x = margin;
     y = (m_infoPanel.getLocalBounds().height + m_infoPanel.getLocalBounds().top - m_timeText.getLocalBounds().height - m_timeText.getLocalBounds().top) / 2;
     m_timeText.setPosition(x, y);
-    m_window.draw(m_timeText);
+    draw(m_window, m_timeText);
 }
 
 void UserInterface::renderTileMap()
 {
-    const auto tileMap = m_game.getTileMap();
-    const auto spriteSize = m_resourceManager.getSpriteSize();
+    const auto visibleChunks = getVisibleChunks();
+    const auto chunkCountInRow = m_game.getChunkCountInRow();
 
-    auto cellSprite = m_resourceManager.getCellSprite();
+    m_tileMapVertices.update(visibleChunks);
 
-    for (size_t i = 0; i < tileMap.size(); i++)
+    m_window.setView(m_boardView);
+
+    for (auto row = visibleChunks.top; row < visibleChunks.bottom; row++)
     {
-        for (size_t j = 0; j < tileMap[i].size(); j++)
-        {
-            sf::Vector2f position(j * spriteSize, i * spriteSize + m_infoPanel.getLocalBounds().top + m_infoPanel.getLocalBounds().height);
+        for (auto column = visibleChunks.left; column < visibleChunks.right; column++)
+            draw(m_window, m_tileMapVertices.getChunk(row * chunkCountInRow + column), &m_resourceManager.getAtlasTexture());
+    }
+
+    m_window.setView(m_window.getDefaultView());
+}
 
-            cellSprite.setPosition(position);
-            m_window.draw(cellSprite);
+/*
+ * Rows [top, bottom) and columns [left, right) of the chunks the view shows at least a part of
+ */
+TileRectangle UserInterface::getVisibleChunks() const
+{
+    const auto chunkSize = static_cast <float>(GameEngine::m_chunkSizeInTiles * m_resourceManager.getSpriteSize());
+    const auto chunkCountInRow = m_game.getChunkCountInRow();
+    const auto chunkCountInColumn = (m_game.getTileMapHeight() + GameEngine::m_chunkSizeInTiles - 1) / GameEngine::m_chunkSizeInTiles;
 
-            if (tileMap[i][j] == Tile::Empty)
-                continue;
+    const auto topLeft = m_boardView.getCenter() - m_boardView.getSize() / 2.0f;
+    const auto bottomRight = m_boardView.getCenter() + m_boardView.getSize() / 2.0f;
 
-            auto ballSprite = m_resourceManager.getBallSprite(tileMap[i][j]);
-            ballSprite.setPosition(position);
-            m_window.draw(ballSprite);
-        }
-    }
+    return TileRectangle {std::clamp(static_cast <int>(std::floor(topLeft.y / chunkSize)), 0, chunkCountInColumn),
+                          std::clamp(static_cast <int>(std::floor(topLeft.x / chunkSize)), 0, chunkCountInRow),
+                          std::clamp(static_cast <int>(std::ceil(bottomRight.y / chunkSize)), 0, chunkCountInColumn),
+                          std::clamp(static_cast <int>(std::ceil(bottomRight.x / chunkSize)), 0, chunkCountInRow)};
+}
+
+/*
+ * The source cell is covered by an empty one, as the tilemap still has the ball there,
+ * and the ball is drawn between the two cells of the path it is rolling through
+ */
+void UserInterface::renderMovingBall()
+{
+    if (!m_isBallMoving)
+        return;
+
+    const auto spriteSize = static_cast <float>(m_resourceManager.getSpriteSize());
+    const auto stepCount = static_cast <int>(m_movePath.size()) - 1;
+    const auto progress = std::min(m_moveClock.getElapsedTime().asSeconds() / m_moveDurationInSeconds, 1.0f) * stepCount;
+    const auto step = std::min(static_cast <int>(progress), stepCount - 1);
+    const auto fraction = progress - step;
+
+    const auto& from = m_movePath[step];
+    const auto& to = m_movePath[step + 1];
+    const auto& source = m_movePath.front();
+
+    m_window.setView(m_boardView);
+
+    m_vacatedCell.setPosition(source.second * spriteSize, source.first * spriteSize);
+    draw(m_window, m_vacatedCell);
+
+    m_movingBall.setPosition((from.second + (to.second - from.second) * fraction) * spriteSize,
+                             (from.first + (to.first - from.first) * fraction) * spriteSize);
+    draw(m_window, m_movingBall);
+
+    m_window.setView(m_window.getDefaultView());
+}
+
+/*
+ * Frames the ball and the cell of the hint if the position is still the same
+ */
+void UserInterface::renderHint()
+{
+    if (!m_isHintAvailable || m_game.getHash() != m_hintHash)
+        return;
+
+    const auto spriteSize = m_resourceManager.getSpriteSize();
+
+    m_window.setView(m_boardView);
+
+    m_hintFrame.setPosition(m_hint.sourceColumn * spriteSize, m_hint.sourceRow * spriteSize);
+    draw(m_window, m_hintFrame);
+
+    m_hintFrame.setPosition(m_hint.destinationColumn * spriteSize, m_hint.destinationRow * spriteSize);
+    draw(m_window, m_hintFrame);
+
+    m_window.setView(m_window.getDefaultView());
 }
 
 void UserInterface::renderGameOverPanel()
@@ -180,12 +601,62 @@ void UserInterface::renderGameOverPanel()
 
     m_gameOverPanel.setPosition(left, top);
     m_gameOverPanel.setSize(sf::Vector2f(width, height));
-    m_window.draw(m_gameOverPanel);
+    draw(m_window, m_gameOverPanel);
 
     // The text is placed in the center of the overlay
     const auto x = (width + left - m_gameOverText.getLocalBounds().left - m_gameOverText.getLocalBounds().width) / 2;
     const auto y = (height + top - m_gameOverText.getLocalBounds().top - m_gameOverText.getLocalBounds().height) / 2;
 
     m_gameOverText.setPosition(x, y);
-    m_window.draw(m_gameOverText);
+    draw(m_window, m_gameOverText);
+}
+
+/*
+ * The latest frames are shown upon the tilemap, the text changes twice a second
+ */
+void UserInterface::renderOverlay()
+{
+    if (!m_isOverlayVisible)
+        return;
+
+    if (m_overlayClock.getElapsedTime() >= m_overlayRefreshTime)
+    {
+        updateOverlayText();
+        m_overlayClock.restart();
+    }
+
+    const auto bounds = m_overlayText.getGlobalBounds();
+    m_overlayPanel.setSize(sf::Vector2f(bounds.left + bounds.width - m_overlayPanel.getPosition().x + 3,
+                                        bounds.top + bounds.height - m_overlayPanel.getPosition().y + 3));
+
+    draw(m_window, m_overlayPanel);
+    draw(m_window, m_overlayText);
+}
+
+/*
+ * Ten seconds of frames at 30 frames a second
+ */
+void UserInterface::updateOverlayText()
+{
+    const auto statistics = m_profiler.getStatistics(300);
+
+    m_overlayString.clear();
+
+    std::snprintf(m_textBuffer.data(), m_textBuffer.size(), "frame p50 %.1f ms\n", statistics.frameMedian);
+    m_overlayString += m_textBuffer.data();
+
+    std::snprintf(m_textBuffer.data(), m_textBuffer.size(), "frame p99 %.1f ms\n", statistics.frame99th);
+    m_overlayString += m_textBuffer.data();
+
+    std::snprintf(m_textBuffer.data(), m_textBuffer.size(), "draws %.1f\n", statistics.meanDrawCallCount);
+    m_overlayString += m_textBuffer.data();
+
+    for (auto i = 0; i < FrameProfiler::m_phaseCount; i++)
+    {
+        std::snprintf(m_textBuffer.data(), m_textBuffer.size(), "%s p99 %.1f ms\n",
+                      FrameProfiler::getName(static_cast <FramePhase>(i)), statistics.phase99th[i]);
+        m_overlayString += m_textBuffer.data();
+    }
+
+    m_overlayText.setString(m_overlayString);
 }
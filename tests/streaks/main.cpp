@@ -0,0 +1,196 @@
+#include "GameEngine.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+/*
+ * Plays seeded random games on boards of random sizes and writes the snapshot after every move,
+ * or plays them again and compares every snapshot with the written ones
+ *
+ * The test builds it with both backends of the streaks: the scalar one writes and the bitboard one compares,
+ * a snapshot holds the tiles, the score and the order of the free cells,
+ * so both must clear the same balls in the same order and drop the new balls on the same cells
+ */
+
+namespace
+{
+    const int gameCount = 300;
+    const int maxMoveCount = 300;
+
+    // Every few moves are taken back and made again, so the undo of a streak is compared too
+    const int undoPeriod = 7;
+
+    const int snapshotScoreOffset = 20;
+    const int snapshotHeaderSize = 64;
+}
+
+void printUsage()
+{
+    std::cout << "Usage: colorlines_test_streaks write|compare FILE\n"
+              << "  write    plays the games and writes the snapshot after every move\n"
+              << "  compare  plays the same games and fails at the first snapshot that differs\n";
+}
+
+using StepHandler = std::function <void(const int, const int, const GameEngine&, const std::vector <unsigned char>&)>;
+
+/*
+ * Small boards with few colors make streaks of every direction often,
+ * the boards of five tiles have streaks of a single ball, which are never cleared
+ */
+void playGames(const StepHandler& handleStep)
+{
+    std::vector <Move> moves;
+    std::vector <unsigned char> snapshot;
+
+    for (auto gameIndex = 0; gameIndex < gameCount; gameIndex++)
+    {
+        RandomNumberGenerator random;
+        random.setSeed(gameIndex);
+
+        GameEngine game;
+        game.setRandomSeed(RandomNumberGenerator::mixSeed(gameIndex, 1));
+        game.startNewGame(random.getInteger(5, 17), random.getInteger(5, 17), random.getInteger(2, 9));
+
+        for (auto moveIndex = 0; moveIndex < maxMoveCount && !game.isGameOver(); moveIndex++)
+        {
+            game.generateMoves(moves);
+            if (moves.empty())
+                break;
+
+            if (!game.applyMove(moves[random.getInteger(0, static_cast <int>(moves.size()))]))
+                throw std::runtime_error("A generated move is not possible");
+
+            if (moveIndex % undoPeriod == undoPeriod - 1 && (!game.undo() || !game.redo()))
+                throw std::runtime_error("The move cannot be taken back and made again");
+
+            snapshot.resize(game.getSnapshotSize());
+            game.save(snapshot);
+            handleStep(gameIndex, moveIndex, game, snapshot);
+        }
+    }
+}
+
+void writeSnapshots(const std::string& path)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Cannot create " + path);
+
+    auto stepCount = 0;
+
+    playGames([&](const int, const int, const GameEngine&, const std::vector <unsigned char>& snapshot)
+    {
+        const auto size = static_cast <std::uint32_t>(snapshot.size());
+        file.write(reinterpret_cast <const char*>(&size), sizeof(size));
+        file.write(reinterpret_cast <const char*>(snapshot.data()), snapshot.size());
+        stepCount++;
+    });
+
+    if (!file.flush())
+        throw std::runtime_error("Cannot write " + path);
+
+    std::cout << "Games: " << gameCount << ", moves: " << stepCount << '\n';
+}
+
+/*
+ * The first difference is told as the part of the snapshot it is in
+ */
+std::string findDifference(const GameEngine& game, const std::vector <unsigned char>& snapshot, const std::vector <unsigned char>& expected)
+{
+    if (snapshot.size() != expected.size())
+        return "the numbers of free cells differ";
+
+    if (std::memcmp(snapshot.data() + snapshotScoreOffset, expected.data() + snapshotScoreOffset, 4) != 0)
+        return "the scores differ";
+
+    const auto tileEnd = snapshotHeaderSize + game.getTileMap().getCellCount();
+
+    if (std::memcmp(snapshot.data() + snapshotHeaderSize, expected.data() + snapshotHeaderSize, tileEnd - snapshotHeaderSize) != 0)
+        return "the tiles differ";
+
+    if (std::memcmp(snapshot.data() + tileEnd, expected.data() + tileEnd, snapshot.size() - tileEnd) != 0)
+        return "the orders of the free cells differ";
+
+    return "the headers differ";
+}
+
+int compareSnapshots(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Cannot open " + path);
+
+    std::vector <unsigned char> expected;
+    auto stepCount = 0;
+    auto failureCount = 0;
+
+    playGames([&](const int gameIndex, const int moveIndex, const GameEngine& game, const std::vector <unsigned char>& snapshot)
+    {
+        // Only the first difference is told, everything after it follows from there
+        if (failureCount > 0)
+            return;
+
+        std::uint32_t size = 0;
+        file.read(reinterpret_cast <char*>(&size), sizeof(size));
+        expected.resize(size);
+        file.read(reinterpret_cast <char*>(expected.data()), size);
+
+        if (!file)
+            throw std::runtime_error("The written games end before game " + std::to_string(gameIndex));
+
+        if (snapshot != expected)
+        {
+            std::cout << "Game " << gameIndex << ", move " << moveIndex << ": "
+                      << findDifference(game, snapshot, expected) << '\n';
+            failureCount++;
+        }
+
+        stepCount++;
+    });
+
+    if (failureCount > 0)
+        return 1;
+
+    if (file.peek() != std::char_traits <char>::eof())
+        throw std::runtime_error("The written games have more moves");
+
+    std::cout << "Games: " << gameCount << ", moves: " << stepCount << ", all equal\n";
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::vector <std::string> arguments(argv, argv + argc);
+
+    try
+    {
+        if (arguments.size() != 3)
+        {
+            printUsage();
+            return 1;
+        }
+
+        if (arguments[1] == "write")
+        {
+            writeSnapshots(arguments[2]);
+            return 0;
+        }
+
+        if (arguments[1] == "compare")
+            return compareSnapshots(arguments[2]);
+
+        throw std::runtime_error("Unknown command " + arguments[1]);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+}
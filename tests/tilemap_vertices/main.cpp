@@ -0,0 +1,183 @@
+#include "GameEngine.hpp"
+#include "TileMapVertices.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+
+/*
+ * Updates the vertices of the tilemap while random games go on and counts the heap allocations of the updates
+ *
+ * Every update prepares the chunks in sight, the way the interface does before drawing them in a frame,
+ * and reads the quads of every chunk through the rectangles of the tiles
+ * Only the first update builds the chunks, every later one must allocate nothing,
+ * while the moves between the updates may allocate as they like
+ * The rest of a frame, the drawing, the profiler, the logger and the texts, needs a window and is not checked
+ */
+
+namespace
+{
+    // Replacing the global operator new counts every allocation of the program, SFML included
+    std::uint64_t allocationCount = 0;
+
+    const int gameCount = 20;
+    const int maxMoveCount = 200;
+    const int maxMoveTryCount = 1000;
+    const int spriteSize = 64;
+}
+
+void* operator new(std::size_t size)
+{
+    allocationCount++;
+
+    if (const auto pointer = std::malloc(size == 0 ? 1 : size))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    allocationCount++;
+
+    const auto align = static_cast <std::size_t>(alignment);
+    if (const auto pointer = std::aligned_alloc(align, (size + align - 1) / align * align))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+/*
+ * Every tile gets its own rectangle, as the atlas would give it
+ */
+TileMapVertices::TextureRects makeTextureRects()
+{
+    TileMapVertices::TextureRects rects;
+
+    for (auto i = 0; i < static_cast <int>(Tile::Count); i++)
+        rects[i] = sf::IntRect(i * spriteSize, 0, spriteSize, spriteSize);
+
+    return rects;
+}
+
+/*
+ * The ball is the first one from a random cell on, and the destination is tried at random,
+ * as huge tilemaps have millions of moves to generate
+ */
+bool makeRandomMove(GameEngine& game, RandomNumberGenerator& random)
+{
+    const auto& tileMap = game.getTileMap();
+    const auto width = tileMap.getWidth();
+    const auto cellCount = width * tileMap.getHeight();
+
+    auto source = random.getInteger(0, cellCount);
+    for (auto i = 0; i < cellCount && !isBall(tileMap.get(source / width, source % width)); i++)
+        source = (source + 1) % cellCount;
+
+    for (auto i = 0; i < maxMoveTryCount; i++)
+    {
+        const auto destination = random.getInteger(0, cellCount);
+        const Move move {source / width, source % width, destination / width, destination % width};
+
+        if (game.isMovePossible(move))
+            return game.applyMove(move);
+    }
+
+    return false;
+}
+
+struct UpdateCounts
+{
+    int updateCount;
+    std::uint64_t vertexCount;
+    std::uint64_t allocationCount;
+};
+
+/*
+ * Counts the updates after the first one of every game
+ */
+UpdateCounts playGames(const int width, const int height, const TileRectangle& visibleChunks)
+{
+    const auto textureRects = makeTextureRects();
+    UpdateCounts counts {0, 0, 0};
+
+    for (auto gameIndex = 0; gameIndex < gameCount; gameIndex++)
+    {
+        RandomNumberGenerator random;
+        random.setSeed(gameIndex);
+
+        GameEngine game;
+        game.setRandomSeed(gameIndex);
+        game.startNewGame(width, height, 7);
+
+        TileMapVertices vertices(game, textureRects, spriteSize);
+        vertices.update(visibleChunks);
+
+        for (auto moveIndex = 0; moveIndex < maxMoveCount && !game.isGameOver(); moveIndex++)
+        {
+            if (!makeRandomMove(game, random))
+                break;
+
+            // Taking back a move changes the tilemap the same way, so it is drawn too
+            if (random.getInteger(0, 4) == 0)
+                game.undo();
+
+            const auto startCount = allocationCount;
+
+            vertices.update(visibleChunks);
+
+            for (auto row = visibleChunks.top; row < visibleChunks.bottom; row++)
+            {
+                for (auto column = visibleChunks.left; column < visibleChunks.right; column++)
+                    counts.vertexCount += vertices.getChunk(row * game.getChunkCountInRow() + column).getVertexCount();
+            }
+
+            counts.allocationCount += allocationCount - startCount;
+            counts.updateCount++;
+        }
+    }
+
+    return counts;
+}
+
+int main()
+{
+    // The whole default board is one chunk, a huge board is seen through a few chunks in its middle
+    const UpdateCounts boardCounts[] {playGames(9, 9, TileRectangle {0, 0, 1, 1}),
+                                     playGames(300, 200, TileRectangle {2, 3, 5, 7})};
+
+    auto isPassed = true;
+
+    for (const auto& counts : boardCounts)
+    {
+        std::cout << "Updates: " << counts.updateCount
+                  << ", vertices: " << counts.vertexCount
+                  << ", allocations: " << counts.allocationCount << '\n';
+
+        isPassed = isPassed && counts.updateCount > 0 && counts.allocationCount == 0;
+    }
+
+    return isPassed ? 0 : 1;
+}
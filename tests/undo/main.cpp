@@ -0,0 +1,101 @@
+#include "GameEngine.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include <iostream>
+#include <vector>
+
+/*
+ * Plays seeded random games and takes back every move to make it once more
+ *
+ * The snapshot after the undo must be the same bytes as the one before the move,
+ * the order of the free cells and the state of the generator included,
+ * and the move made again must give the same snapshot as the first time, the same new balls too
+ */
+
+namespace
+{
+    const int gameCount = 300;
+    const int maxMoveCount = 300;
+}
+
+struct UndoCounts
+{
+    int moveCount;
+    int undoFailureCount;
+    int replayFailureCount;
+};
+
+UndoCounts playGames()
+{
+    std::vector <Move> moves;
+    std::vector <unsigned char> before;
+    std::vector <unsigned char> after;
+    std::vector <unsigned char> snapshot;
+    UndoCounts counts {0, 0, 0};
+
+    const auto save = [](const GameEngine& game, std::vector <unsigned char>& buffer)
+    {
+        buffer.resize(game.getSnapshotSize());
+        game.save(buffer);
+    };
+
+    for (auto gameIndex = 0; gameIndex < gameCount; gameIndex++)
+    {
+        RandomNumberGenerator random;
+        random.setSeed(gameIndex);
+
+        GameEngine game;
+        game.setRandomSeed(RandomNumberGenerator::mixSeed(gameIndex, 2));
+        game.startNewGame(random.getInteger(5, 17), random.getInteger(5, 17), random.getInteger(2, 9));
+
+        for (auto moveIndex = 0; moveIndex < maxMoveCount && !game.isGameOver(); moveIndex++)
+        {
+            game.generateMoves(moves);
+            if (moves.empty())
+                break;
+
+            const auto move = moves[random.getInteger(0, static_cast <int>(moves.size()))];
+
+            save(game, before);
+            game.applyMove(move);
+            save(game, after);
+
+            game.undo();
+            save(game, snapshot);
+
+            if (snapshot != before)
+            {
+                if (counts.undoFailureCount == 0)
+                    std::cout << "Game " << gameIndex << ", move " << moveIndex << ": the undo does not restore the position\n";
+
+                counts.undoFailureCount++;
+            }
+
+            game.applyMove(move);
+            save(game, snapshot);
+
+            if (snapshot != after)
+            {
+                if (counts.replayFailureCount == 0)
+                    std::cout << "Game " << gameIndex << ", move " << moveIndex << ": the move made again gives another position\n";
+
+                counts.replayFailureCount++;
+            }
+
+            counts.moveCount++;
+        }
+    }
+
+    return counts;
+}
+
+int main()
+{
+    const auto counts = playGames();
+
+    std::cout << "Moves: " << counts.moveCount
+              << ", undos not restoring: " << counts.undoFailureCount
+              << ", moves made again differently: " << counts.replayFailureCount << '\n';
+
+    return (counts.moveCount > 0 && counts.undoFailureCount == 0 && counts.replayFailureCount == 0) ? 0 : 1;
+}
@@ -0,0 +1,541 @@
+#include "GameEngine.hpp"
+#include "RandomMovePolicy.hpp"
+#include "ExpectimaxMovePolicy.hpp"
+#include "MctsMovePolicy.hpp"
+#include "Simulator.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+#include <optional>
+
+/*
+ * Measures the hot paths of the engine on a fixed corpus of boards
+ *
+ * Every board is made from its own seed, so the same size and fill level
+ * give the same board on every run and on every commit
+ * Run with --benchmark_out=FILE --benchmark_out_format=json to compare commits
+ */
+
+namespace
+{
+    const int colorCount = 8;
+    const int sampleCount = 1024;
+}
+
+/*
+ * The engine names this class as a friend, so the private steps of a move
+ * can be measured on their own
+ */
+class GameEngineBenchmark
+{
+    public:
+        // Fills the given percent of the cells with balls of random colors
+        static void makeBoard(GameEngine& game, const int size, const int fillPercent)
+        {
+            game.setRandomSeed(RandomNumberGenerator::mixSeed(size, fillPercent));
+            game.startNewGame(size, size, colorCount);
+
+            const auto cellCount = size * size;
+            const auto targetFreeCount = cellCount - cellCount * fillPercent / 100;
+
+            while (game.m_freeCells.getCount() > targetFreeCount)
+            {
+                const auto index = game.m_freeCells[game.m_random.getInteger(0, game.m_freeCells.getCount())];
+                game.setTile(index, game.m_random.getTile(Tile::ColorOne, Tile::ColorOne + static_cast <Tile>(colorCount)));
+            }
+
+            game.clearDirtyRegion();
+        }
+
+        static std::vector <int> collectCells(const GameEngine& game, bool (*isWanted)(Tile))
+        {
+            const auto& board = game.getTileMap();
+            std::vector <int> cells;
+
+            for (auto row = 0; row < board.getHeight(); row++)
+            {
+                for (auto column = 0; column < board.getWidth(); column++)
+                {
+                    if (isWanted(board.get(row, column)))
+                        cells.push_back(board.toIndex(row, column));
+                }
+            }
+
+            return cells;
+        }
+
+        static int getMinStreakLength(const GameEngine& game)
+        {
+            return game.m_minStreakLength;
+        }
+
+        static bool pathExists(const GameEngine& game, const int sourceIndex, const int destinationIndex)
+        {
+            return game.pathExists(sourceIndex, destinationIndex);
+        }
+
+        static void setTile(GameEngine& game, const int index, const Tile tile)
+        {
+            game.setTile(index, tile);
+        }
+
+        static int deleteStreaks(GameEngine& game, const int index)
+        {
+            return game.deleteStreaks(index);
+        }
+
+        static int addExpectedBalls(GameEngine& game, const int count)
+        {
+            return game.addExpectedBalls(count);
+        }
+
+        static void transformExpectedBalls(GameEngine& game)
+        {
+            game.transformExpectedBalls();
+        }
+};
+
+static bool isEmptyCell(const Tile tile)
+{
+    return tile == Tile::Empty;
+}
+
+static void BM_PathExists(benchmark::State& state)
+{
+    GameEngine game;
+    GameEngineBenchmark::makeBoard(game, state.range(0), state.range(1));
+
+    // Pairs of a ball and an empty cell, as the second pick of a move sees them
+    const auto balls = GameEngineBenchmark::collectCells(game, isBall);
+    const auto emptyCells = GameEngineBenchmark::collectCells(game, isEmptyCell);
+    RandomNumberGenerator random;
+    random.setSeed(state.range(0));
+
+    std::vector <std::pair <int, int>> pairs(sampleCount);
+    for (auto& pair : pairs)
+    {
+        pair.first = balls[random.getInteger(0, balls.size())];
+        pair.second = emptyCells[random.getInteger(0, emptyCells.size())];
+    }
+
+    auto i = 0;
+    for (auto _ : state)
+    {
+        const auto& pair = pairs[i++ % sampleCount];
+        benchmark::DoNotOptimize(GameEngineBenchmark::pathExists(game, pair.first, pair.second));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+/*
+ * Only possible moves are searched, the impossible ones never get past the regions
+ */
+static void BM_FindPath(benchmark::State& state)
+{
+    GameEngine game;
+    GameEngineBenchmark::makeBoard(game, state.range(0), state.range(1));
+
+    std::vector <Move> moves;
+    game.generateMoves(moves);
+
+    if (moves.empty())
+    {
+        state.SkipWithError("No possible moves");
+        return;
+    }
+
+    RandomNumberGenerator random;
+    random.setSeed(state.range(0));
+
+    std::vector <Move> samples(sampleCount);
+    for (auto& sample : samples)
+        sample = moves[random.getInteger(0, moves.size())];
+
+    std::vector <std::pair <int, int>> path;
+    std::int64_t cellCount = 0;
+
+    auto i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(game.findPath(samples[i++ % sampleCount], path));
+        cellCount += path.size();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["path"] = benchmark::Counter(static_cast <double>(cellCount), benchmark::Counter::kAvgIterations);
+}
+
+/*
+ * A streak is put in the middle row and deleted, then the row is restored,
+ * so every iteration sees the same board
+ */
+static void BM_DeleteStreaks(benchmark::State& state)
+{
+    GameEngine game;
+    GameEngineBenchmark::makeBoard(game, state.range(0), state.range(1));
+
+    const auto& board = game.getTileMap();
+    const auto length = GameEngineBenchmark::getMinStreakLength(game);
+    const auto first = board.toIndex(board.getHeight() / 2, 0);
+
+    std::vector <Tile> savedTiles(length);
+    for (auto i = 0; i < length; i++)
+        savedTiles[i] = board[first + i];
+
+    for (auto _ : state)
+    {
+        for (auto i = 0; i < length; i++)
+            GameEngineBenchmark::setTile(game, first + i, Tile::ColorOne);
+
+        benchmark::DoNotOptimize(GameEngineBenchmark::deleteStreaks(game, first + length / 2));
+
+        for (auto i = 0; i < length; i++)
+            GameEngineBenchmark::setTile(game, first + i, savedTiles[i]);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+/*
+ * The board is restored from a copy with the timer paused
+ */
+static void BM_AddExpectedBalls(benchmark::State& state)
+{
+    GameEngine original;
+    GameEngineBenchmark::makeBoard(original, state.range(0), state.range(1));
+
+    std::optional <GameEngine> game;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        game.emplace(original);
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(GameEngineBenchmark::addExpectedBalls(*game, 3));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_TransformExpectedBalls(benchmark::State& state)
+{
+    GameEngine original;
+    GameEngineBenchmark::makeBoard(original, state.range(0), state.range(1));
+
+    std::optional <GameEngine> game;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        game.emplace(original);
+        GameEngineBenchmark::addExpectedBalls(*game, 3);
+        state.ResumeTiming();
+
+        GameEngineBenchmark::transformExpectedBalls(*game);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+/*
+ * Both picks of a possible move, which include the path search, the streaks and the new balls
+ */
+static void BM_ProcessPick(benchmark::State& state)
+{
+    GameEngine original;
+    GameEngineBenchmark::makeBoard(original, state.range(0), state.range(1));
+
+    const auto& board = original.getTileMap();
+    const auto balls = GameEngineBenchmark::collectCells(original, isBall);
+    const auto emptyCells = GameEngineBenchmark::collectCells(original, isEmptyCell);
+    RandomNumberGenerator random;
+    random.setSeed(state.range(0));
+
+    std::vector <Move> moves;
+    for (auto attempt = 0; attempt < 16 * sampleCount && static_cast <int>(moves.size()) < sampleCount; attempt++)
+    {
+        const auto source = balls[random.getInteger(0, balls.size())];
+        const auto destination = emptyCells[random.getInteger(0, emptyCells.size())];
+        const Move move {board.toRow(source), board.toColumn(source), board.toRow(destination), board.toColumn(destination)};
+
+        if (original.isMovePossible(move))
+            moves.push_back(move);
+    }
+
+    if (moves.empty())
+    {
+        state.SkipWithError("No possible move on the board");
+        return;
+    }
+
+    std::optional <GameEngine> game;
+    auto i = 0;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        game.emplace(original);
+        const auto& move = moves[i++ % moves.size()];
+        state.ResumeTiming();
+
+        game->processPick(move.sourceRow, move.sourceColumn);
+        game->processPick(move.destinationRow, move.destinationColumn);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_GenerateMoves(benchmark::State& state)
+{
+    GameEngine game;
+    GameEngineBenchmark::makeBoard(game, state.range(0), state.range(1));
+
+    std::vector <Move> moves;
+
+    for (auto _ : state)
+    {
+        game.generateMoves(moves);
+        benchmark::DoNotOptimize(moves.data());
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["moves"] = static_cast <double>(moves.size());
+}
+
+/*
+ * The same moves as for the picks, made at once
+ */
+static void BM_ApplyMove(benchmark::State& state)
+{
+    GameEngine original;
+    GameEngineBenchmark::makeBoard(original, state.range(0), state.range(1));
+
+    std::vector <Move> moves;
+    original.generateMoves(moves);
+
+    if (moves.empty())
+    {
+        state.SkipWithError("No possible move on the board");
+        return;
+    }
+
+    std::optional <GameEngine> game;
+    auto i = 0;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        game.emplace(original);
+        const auto& move = moves[(i++ * 7919) % moves.size()];
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(game->applyMove(move));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+/*
+ * A move and its undo on the same engine, as a search makes and unmakes moves
+ */
+static void BM_MakeUnmake(benchmark::State& state)
+{
+    GameEngine game;
+    GameEngineBenchmark::makeBoard(game, state.range(0), state.range(1));
+
+    std::vector <Move> moves;
+    game.generateMoves(moves);
+
+    if (moves.empty())
+    {
+        state.SkipWithError("No possible move on the board");
+        return;
+    }
+
+    auto i = 0;
+
+    for (auto _ : state)
+    {
+        game.applyMove(moves[(i++ * 7919) % moves.size()]);
+        game.undo();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+/*
+ * The same on huge boards, which have too many moves to generate,
+ * so random balls are moved to random cells
+ * The time of a move must not grow with the board
+ */
+static void BM_HugeBoardMakeUnmake(benchmark::State& state)
+{
+    const auto size = static_cast <int>(state.range(0));
+
+    GameEngine game;
+    GameEngineBenchmark::makeBoard(game, size, 10);
+
+    RandomNumberGenerator random;
+    random.setSeed(size);
+
+    std::vector <Move> moves;
+
+    while (static_cast <int>(moves.size()) < sampleCount)
+    {
+        const Move move {random.getInteger(0, size), random.getInteger(0, size),
+                         random.getInteger(0, size), random.getInteger(0, size)};
+
+        if (game.isMovePossible(move))
+            moves.push_back(move);
+    }
+
+    auto i = 0;
+
+    for (auto _ : state)
+    {
+        game.applyMove(moves[(i++ * 7919) % moves.size()]);
+        game.undo();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+/*
+ * Forking a position: the snapshot is written into a reused buffer and loaded into another engine
+ */
+static void BM_SnapshotSave(benchmark::State& state)
+{
+    GameEngine game;
+    GameEngineBenchmark::makeBoard(game, state.range(0), state.range(1));
+
+    std::vector <unsigned char> snapshot(game.getSnapshotSize());
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(game.save(snapshot));
+
+    state.SetBytesProcessed(state.iterations() * snapshot.size());
+}
+
+static void BM_SnapshotLoad(benchmark::State& state)
+{
+    GameEngine game;
+    GameEngineBenchmark::makeBoard(game, state.range(0), state.range(1));
+
+    std::vector <unsigned char> snapshot(game.getSnapshotSize());
+    game.save(snapshot);
+
+    GameEngine copy;
+
+    for (auto _ : state)
+    {
+        copy.load(snapshot);
+        benchmark::DoNotOptimize(copy.getHash());
+    }
+
+    state.SetBytesProcessed(state.iterations() * snapshot.size());
+}
+
+/*
+ * One decision of the search at a fixed depth, the table is cleared before each of them
+ */
+static void BM_ExpectimaxSearch(benchmark::State& state)
+{
+    GameEngine game;
+    GameEngineBenchmark::makeBoard(game, state.range(0), state.range(1));
+
+    ExpectimaxMovePolicy policy;
+    policy.setMaxDepth(2);
+
+    SearchResult result;
+    std::int64_t nodeCount = 0;
+    std::uint64_t seed = 0;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        policy.setSeed(seed++);
+        state.ResumeTiming();
+
+        policy.search(game, result);
+        nodeCount += result.nodeCount;
+    }
+
+    state.SetItemsProcessed(nodeCount);
+    state.counters["nodes"] = benchmark::Counter(nodeCount, benchmark::Counter::kAvgIterations);
+}
+
+/*
+ * One decision of a fixed number of playouts, shared by the given number of threads in one tree
+ */
+static void BM_MctsSearch(benchmark::State& state)
+{
+    GameEngine game;
+    GameEngineBenchmark::makeBoard(game, 9, state.range(0));
+
+    MctsMovePolicy policy;
+    policy.setPlayoutBudget(1000);
+    policy.setThreadCount(state.range(1));
+
+    MctsResult result;
+    std::int64_t playoutCount = 0;
+
+    for (auto _ : state)
+    {
+        policy.search(game, result);
+        playoutCount += result.playoutCount;
+    }
+
+    state.SetItemsProcessed(playoutCount);
+}
+
+/*
+ * Whole games of the random policy, every iteration is another seed
+ */
+static void BM_Playout(benchmark::State& state)
+{
+    const auto size = static_cast <int>(state.range(0));
+
+    GameEngine game;
+    RandomMovePolicy policy;
+    Simulator simulator(policy);
+
+    std::uint64_t seed = 0;
+    std::int64_t moveCount = 0;
+
+    for (auto _ : state)
+    {
+        game.setRandomSeed(RandomNumberGenerator::mixSeed(size, seed));
+        policy.setSeed(RandomNumberGenerator::mixSeed(size, seed + 1));
+        seed += 2;
+
+        const auto result = simulator.playGame(game, size, size, colorCount, 1000);
+        moveCount += result.moveCount;
+    }
+
+    state.SetItemsProcessed(moveCount);
+    state.counters["moves_per_game"] = benchmark::Counter(moveCount, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_PathExists)->ArgNames({"size", "fill"})->ArgsProduct({{9, 16, 32, 64}, {10, 50, 90}});
+BENCHMARK(BM_FindPath)->ArgNames({"size", "fill"})->ArgsProduct({{9, 16, 32, 64}, {10, 50, 90}});
+BENCHMARK(BM_DeleteStreaks)->ArgNames({"size", "fill"})->ArgsProduct({{9, 16, 32, 64}, {10, 50, 90}});
+BENCHMARK(BM_AddExpectedBalls)->ArgNames({"size", "fill"})->ArgsProduct({{9, 16, 32, 64}, {10, 50, 90}});
+BENCHMARK(BM_TransformExpectedBalls)->ArgNames({"size", "fill"})->ArgsProduct({{9, 16, 32, 64}, {10, 50, 90}});
+BENCHMARK(BM_ProcessPick)->ArgNames({"size", "fill"})->ArgsProduct({{9, 16, 32, 64}, {10, 50, 90}});
+BENCHMARK(BM_GenerateMoves)->ArgNames({"size", "fill"})->ArgsProduct({{9, 16, 32, 64}, {10, 50, 90}});
+BENCHMARK(BM_ApplyMove)->ArgNames({"size", "fill"})->ArgsProduct({{9, 16, 32, 64}, {10, 50, 90}});
+BENCHMARK(BM_MakeUnmake)->ArgNames({"size", "fill"})->ArgsProduct({{9, 16, 32, 64}, {10, 50, 90}});
+BENCHMARK(BM_HugeBoardMakeUnmake)->ArgName("size")->Arg(64)->Arg(512)->Arg(4096);
+BENCHMARK(BM_SnapshotSave)->ArgNames({"size", "fill"})->ArgsProduct({{9, 64, 512}, {10, 50, 90}});
+BENCHMARK(BM_SnapshotLoad)->ArgNames({"size", "fill"})->ArgsProduct({{9, 64, 512}, {10, 50, 90}});
+BENCHMARK(BM_ExpectimaxSearch)->ArgNames({"size", "fill"})->ArgsProduct({{9, 16}, {10, 50, 90}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MctsSearch)->ArgNames({"fill", "threads"})->ArgsProduct({{10, 50, 90}, {1, 2, 4, 8}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// The policy lists every possible move, their number grows as the square of the area,
+// so bigger boards take seconds per game
+BENCHMARK(BM_Playout)->ArgName("size")->Arg(9)->Arg(16)->Arg(32)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,158 @@
+#include "ReplayCorpus.hpp"
+#include "SnapshotFile.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <limits>
+#include <stdexcept>
+
+/*
+ * Joins replay files into a corpus and answers queries about its games
+ */
+
+void printUsage()
+{
+    std::cout << "Usage: colorlines_corpus COMMAND ...\n"
+              << "  build CORPUS REPLAY...           join replay files into a corpus\n"
+              << "  find CORPUS [options]            list the games of the corpus\n"
+              << "    --min-score N                  only games with a score of at least N\n"
+              << "    --max-score N                  only games with a score of at most N\n"
+              << "    --unfinished                   only games without the end\n"
+              << "    --limit N                      list at most N games, all are counted\n"
+              << "  position CORPUS GAME ACTIONS [SNAPSHOT]\n"
+              << "                                   the board after the given number of actions of the game,\n"
+              << "                                   also saved as a snapshot to continue, e.g. by colorlines_sim --start\n";
+}
+
+int findGames(const std::vector <std::string>& arguments)
+{
+    auto minScore = std::numeric_limits <int>::min();
+    auto maxScore = std::numeric_limits <int>::max();
+    auto isUnfinishedOnly = false;
+    size_t limit = 20;
+
+    for (size_t i = 3; i < arguments.size(); i++)
+    {
+        const auto& name = arguments[i];
+
+        if (name == "--unfinished")
+        {
+            isUnfinishedOnly = true;
+            continue;
+        }
+
+        if (i + 1 >= arguments.size())
+            throw std::runtime_error("Missing value for " + name);
+
+        const auto& value = arguments[++i];
+
+        if (name == "--min-score")
+            minScore = std::stoi(value);
+        else if (name == "--max-score")
+            maxScore = std::stoi(value);
+        else if (name == "--limit")
+            limit = std::stoul(value);
+        else
+            throw std::runtime_error("Unknown option " + name);
+    }
+
+    ReplayCorpus corpus(arguments[2]);
+
+    const auto games = corpus.findGames([=](const CorpusEntry& entry)
+    {
+        return entry.score >= minScore && entry.score <= maxScore && (!isUnfinishedOnly || !entry.isFinished);
+    });
+
+    std::cout << "Games: " << games.size() << " of " << corpus.getGameCount() << '\n';
+
+    for (size_t i = 0; i < games.size() && i < limit; i++)
+    {
+        const auto entry = corpus.getEntry(games[i]);
+
+        std::cout << "Game " << games[i]
+                  << ": " << entry.widthInTiles << 'x' << entry.heightInTiles
+                  << ", " << entry.colorCount << " colors"
+                  << ", seed " << (entry.isSeeded ? std::to_string(entry.seed) : "none")
+                  << ", score " << entry.score
+                  << ", " << entry.actionCount << " actions"
+                  << (entry.isFinished ? "" : ", unfinished") << '\n';
+    }
+
+    return 0;
+}
+
+/*
+ * Balls are digits, the balls of the next move are letters and empty cells are dots
+ */
+int printPosition(const std::vector <std::string>& arguments)
+{
+    if (arguments.size() != 5 && arguments.size() != 6)
+        throw std::runtime_error("The position needs a corpus, a game and a number of actions");
+
+    ReplayCorpus corpus(arguments[2]);
+    const auto& game = corpus.getPosition(std::stoi(arguments[3]), std::stoi(arguments[4]));
+
+    if (arguments.size() == 6)
+    {
+        SnapshotFile snapshot(arguments[5]);
+        snapshot.save(game);
+    }
+
+    std::cout << "Score: " << game.getScore() << '\n'
+              << "State: " << game.getState() << '\n';
+
+    const auto& map = game.getTileMap();
+    for (auto row = 0; row < map.getHeight(); row++)
+    {
+        for (const auto& tile : map.getRow(row))
+        {
+            if (isExpected(tile))
+                std::cout << static_cast <char>('a' + static_cast <int>(expectedToNormal(tile) - Tile::ColorOne));
+            else if (tile != Tile::Empty)
+                std::cout << static_cast <char>('1' + static_cast <int>((isSelected(tile) ? selectedToNormal(tile) : tile) - Tile::ColorOne));
+            else
+                std::cout << '.';
+        }
+        std::cout << '\n';
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::vector <std::string> arguments(argv, argv + argc);
+
+    try
+    {
+        if (arguments.size() < 3)
+        {
+            printUsage();
+            return arguments.size() == 2 && arguments[1] == "--help" ? 0 : 1;
+        }
+
+        const auto& command = arguments[1];
+
+        if (command == "build")
+        {
+            const std::vector <std::string> replayPaths(arguments.begin() + 3, arguments.end());
+            std::cout << "Games: " << ReplayCorpus::build(arguments[2], replayPaths) << '\n';
+            return 0;
+        }
+
+        if (command == "find")
+            return findGames(arguments);
+
+        if (command == "position")
+            return printPosition(arguments);
+
+        throw std::runtime_error("Unknown command " + command);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << '\n';
+        printUsage();
+        return 1;
+    }
+}
@@ -0,0 +1,77 @@
+#include "Logger.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+/*
+ * Prints the events of a log file as text, one per line
+ */
+
+void printUsage()
+{
+    std::cout << "Usage: colorlines_log FILE [LEVEL]\n"
+              << "  prints the events of the file of the given level and above: debug, info, warning or error (debug)\n";
+}
+
+int main(int argc, char* argv[])
+{
+    const std::vector <std::string> arguments(argv, argv + argc);
+
+    try
+    {
+        if (arguments.size() < 2 || arguments.size() > 3 || arguments[1] == "--help")
+        {
+            printUsage();
+            return arguments.size() == 2 ? 0 : 1;
+        }
+
+        auto minLevel = LogLevel::Debug;
+
+        if (arguments.size() == 3)
+        {
+            auto i = 0;
+            while (i < static_cast <int>(LogLevel::Count) && arguments[2] != Logger::getName(static_cast <LogLevel>(i)))
+                i++;
+
+            if (i == static_cast <int>(LogLevel::Count))
+                throw std::runtime_error("Unknown log level " + arguments[2]);
+
+            minLevel = static_cast <LogLevel>(i);
+        }
+
+        std::int64_t startWallTime = 0;
+        const auto records = Logger::readFile(arguments[1], startWallTime);
+
+        std::cout << "Started: " << startWallTime / 1000000000 << " s since the epoch\n"
+                  << "Events:  " << records.size() << '\n'
+                  << std::fixed << std::setprecision(6);
+
+        for (const auto& record : records)
+        {
+            if (record.level < minLevel)
+                continue;
+
+            std::cout << std::setw(14) << record.time / 1e9
+                      << " thread " << std::setw(3) << record.thread
+                      << ' ' << std::setw(7) << Logger::getName(record.level)
+                      << ' ' << Logger::getName(record.event);
+
+            const auto& fieldNames = Logger::getFieldNames(record.event);
+            for (size_t i = 0; i < fieldNames.size() && fieldNames[i] != nullptr; i++)
+                std::cout << ' ' << fieldNames[i] << '=' << record.values[i];
+
+            std::cout << '\n';
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << '\n';
+        printUsage();
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include "AssetBundle.hpp"
+
+#include <SFML/Graphics/Image.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+
+/*
+ * Decodes the sprites, draws them into the atlas and writes the bundle with the font
+ * as a source file, which is compiled into the game
+ */
+
+namespace
+{
+    const int spriteSize = 64;
+    const int ballColorCount = 8;
+
+    // Lines of the generated array
+    const int bytesPerLine = 24;
+}
+
+void printUsage()
+{
+    std::cout << "Usage: colorlines_pack RESOURCES OUTPUT\n"
+              << "  RESOURCES    the directory of the sprites and the font\n"
+              << "  OUTPUT       the source file to write the bundle into\n";
+}
+
+AssetImage decodeImage(const std::string& path)
+{
+    sf::Image image;
+    if (!image.loadFromFile(path))
+        throw std::runtime_error("Cannot load file " + path);
+
+    const auto size = image.getSize();
+    const auto pixels = image.getPixelsPtr();
+
+    return AssetImage {static_cast <int>(size.x), static_cast <int>(size.y),
+                       std::vector <std::uint8_t>(pixels, pixels + static_cast <std::size_t>(size.x) * size.y * 4)};
+}
+
+/*
+ * Every thread takes the next image until none are left
+ */
+std::vector <AssetImage> decodeImages(const std::vector <std::string>& paths)
+{
+    std::vector <AssetImage> images(paths.size());
+    std::vector <std::exception_ptr> errors(paths.size());
+    std::atomic <std::size_t> next(0);
+
+    const auto threadCount = std::clamp <std::size_t>(std::thread::hardware_concurrency(), 1, paths.size());
+    std::vector <std::thread> threads;
+
+    for (std::size_t i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back([&]()
+        {
+            for (auto image = next++; image < paths.size(); image = next++)
+            {
+                try
+                {
+                    images[image] = decodeImage(paths[image]);
+                }
+                catch (...)
+                {
+                    errors[image] = std::current_exception();
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (const auto& error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    return images;
+}
+
+std::vector <unsigned char> readFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Cannot open file " + path);
+
+    return std::vector <unsigned char>(std::istreambuf_iterator <char>(file), std::istreambuf_iterator <char>());
+}
+
+/*
+ * The array has external linkage, the game declares it where it loads the resources
+ */
+void writeSource(const std::string& path, const std::vector <unsigned char>& bundle)
+{
+    std::string text;
+    text.reserve(bundle.size() * 4 + 256);
+
+    text += "// Generated by colorlines_pack, do not edit\n\n"
+            "#include <cstddef>\n\n"
+            "extern const std::size_t assetBundleSize = " + std::to_string(bundle.size()) + ";\n\n"
+            "extern const unsigned char assetBundleData[] =\n{";
+
+    for (std::size_t i = 0; i < bundle.size(); i++)
+    {
+        text += (i % bytesPerLine == 0) ? "\n    " : " ";
+        text += std::to_string(bundle[i]);
+        text += ',';
+    }
+
+    text += "\n};\n";
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file || !file.write(text.data(), text.size()))
+        throw std::runtime_error("Cannot write file " + path);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        printUsage();
+        return 1;
+    }
+
+    try
+    {
+        const std::string directory = std::string(argv[1]) + "/";
+
+        std::vector <std::string> paths {directory + "cell.png"};
+        for (auto color = 1; color <= ballColorCount; color++)
+            paths.push_back(directory + "ball_" + std::to_string(color) + ".png");
+
+        const auto images = decodeImages(paths);
+        const std::vector <AssetImage> balls(images.begin() + 1, images.end());
+
+        const auto font = readFile(directory + "DigitalNumbers-Regular.ttf");
+        const auto bundle = AssetBundle::pack(images[0], balls, font, spriteSize);
+
+        writeSource(argv[2], bundle);
+        std::cout << "Bundle: " << bundle.size() << " bytes\n";
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
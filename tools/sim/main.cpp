@@ -0,0 +1,390 @@
+#include "GameEngine.hpp"
+#include "RandomMovePolicy.hpp"
+#include "GreedyMovePolicy.hpp"
+#include "ExpectimaxMovePolicy.hpp"
+#include "MctsMovePolicy.hpp"
+#include "BatchRunner.hpp"
+#include "SimulationStatistics.hpp"
+#include "ReplayReader.hpp"
+#include "Instrumentation.hpp"
+#include "SnapshotFile.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+#include <cstdlib>
+
+/*
+ * Plays games without a window and reports the speed of the engine and the scores of the policy
+ */
+
+struct Options
+{
+    int gameCount = 1000;
+    int widthInTiles = 9;
+    int heightInTiles = 9;
+    int colorCount = 8;
+    int maxMoveCount = 100000;
+    std::string policyName = "random";
+    int searchDepth = 2;
+    int playoutCount = 2000;
+    int threadCount = std::max(1, static_cast <int>(std::thread::hardware_concurrency()));
+    std::uint64_t seed = std::chrono::system_clock::now().time_since_epoch().count();
+    bool isSeedGiven = false;
+    std::string outputPath;
+    std::string recordPath;
+    std::string verifyPath;
+    std::string countersPath;
+    std::string logPath;
+    std::string startPath;
+    bool isResumed = false;
+    LogLevel logLevel = LogLevel::Info;
+    RandomNumberGenerator::Algorithm randomAlgorithm = RandomNumberGenerator::Algorithm::Xoshiro256StarStar;
+};
+
+void printUsage()
+{
+    std::cout << "Usage: colorlines_sim [options]\n"
+              << "  --games N       number of games to play (1000)\n"
+              << "  --width N       board width in tiles (9)\n"
+              << "  --height N      board height in tiles (9)\n"
+              << "  --colors N      number of ball colors, 1 to 8 (8)\n"
+              << "  --max-moves N   moves after which a game is stopped (100000)\n"
+              << "  --policy NAME   random, greedy, expectimax or mcts (random)\n"
+              << "  --depth N       moves the expectimax policy looks ahead (2)\n"
+              << "  --playouts N    playouts of the mcts policy for every move (2000)\n"
+              << "  --threads N     number of threads (all cores)\n"
+              << "  --seed N        master seed, the same seed gives the same games (time, or the one of --resume)\n"
+              << "  --output FILE   binary file for the result of every game\n"
+              << "  --record FILE   replay file the games are appended to\n"
+              << "  --verify FILE   replay the games of the file and check their scores instead of playing\n"
+              << "  --counters FILE counters and timers of the engine as JSON, or as Prometheus text for *.prom,\n"
+              << "                  the engine must be built with COLORLINES_INSTRUMENTATION\n"
+              << "  --rng NAME      generator of the engine: xoshiro, pcg or mt (xoshiro)\n"
+              << "  --log FILE      binary log of the events of the games\n"
+              << "  --log-level L   debug, info, warning or error (info)\n"
+              << "  --start FILE    every game continues the snapshot of the file instead of a new board,\n"
+              << "                  the games are not recorded\n"
+              << "  --resume        play only the games missing from the --output file of a stopped batch\n";
+}
+
+RandomNumberGenerator::Algorithm parseAlgorithm(const std::string& name)
+{
+    if (name == "xoshiro")
+        return RandomNumberGenerator::Algorithm::Xoshiro256StarStar;
+
+    if (name == "pcg")
+        return RandomNumberGenerator::Algorithm::Pcg32;
+
+    if (name == "mt")
+        return RandomNumberGenerator::Algorithm::MersenneTwister;
+
+    throw std::runtime_error("Unknown generator " + name);
+}
+
+LogLevel parseLevel(const std::string& name)
+{
+    for (auto i = 0; i < static_cast <int>(LogLevel::Count); i++)
+    {
+        if (name == Logger::getName(static_cast <LogLevel>(i)))
+            return static_cast <LogLevel>(i);
+    }
+
+    throw std::runtime_error("Unknown log level " + name);
+}
+
+Options parseOptions(int argc, char* argv[])
+{
+    Options options;
+
+    for (auto i = 1; i < argc; i++)
+    {
+        const std::string name = argv[i];
+
+        if (name == "--help")
+        {
+            printUsage();
+            std::exit(0);
+        }
+
+        if (name == "--resume")
+        {
+            options.isResumed = true;
+            continue;
+        }
+
+        if (i + 1 >= argc)
+            throw std::runtime_error("Missing value for " + name);
+
+        const std::string value = argv[++i];
+
+        if (name == "--games")
+            options.gameCount = std::stoi(value);
+        else if (name == "--width")
+            options.widthInTiles = std::stoi(value);
+        else if (name == "--height")
+            options.heightInTiles = std::stoi(value);
+        else if (name == "--colors")
+            options.colorCount = std::stoi(value);
+        else if (name == "--max-moves")
+            options.maxMoveCount = std::stoi(value);
+        else if (name == "--policy")
+            options.policyName = value;
+        else if (name == "--depth")
+            options.searchDepth = std::stoi(value);
+        else if (name == "--playouts")
+            options.playoutCount = std::stoi(value);
+        else if (name == "--threads")
+            options.threadCount = std::stoi(value);
+        else if (name == "--seed")
+        {
+            options.seed = std::stoull(value);
+            options.isSeedGiven = true;
+        }
+        else if (name == "--output")
+            options.outputPath = value;
+        else if (name == "--record")
+            options.recordPath = value;
+        else if (name == "--verify")
+            options.verifyPath = value;
+        else if (name == "--counters")
+            options.countersPath = value;
+        else if (name == "--rng")
+            options.randomAlgorithm = parseAlgorithm(value);
+        else if (name == "--log")
+            options.logPath = value;
+        else if (name == "--log-level")
+            options.logLevel = parseLevel(value);
+        else if (name == "--start")
+            options.startPath = value;
+        else
+            throw std::runtime_error("Unknown option " + name);
+    }
+
+    if (options.widthInTiles < GameEngine::m_minSizeInTiles || options.widthInTiles > GameEngine::m_maxSizeInTiles ||
+        options.heightInTiles < GameEngine::m_minSizeInTiles || options.heightInTiles > GameEngine::m_maxSizeInTiles)
+    {
+        throw std::runtime_error("The board must be from 5x5 to 4096x4096");
+    }
+
+    if (options.colorCount < 1 || options.colorCount > 8)
+        throw std::runtime_error("The number of colors must be from 1 to 8");
+
+    if (options.isResumed && options.outputPath.empty())
+        throw std::runtime_error("A batch is resumed from its --output file");
+
+    // A resumed batch goes on with the seed of its file, a given seed must be the same one
+    if (options.isResumed && !options.isSeedGiven)
+        options.seed = ResultFile::readHeader(options.outputPath).masterSeed;
+
+    if (options.searchDepth < 1 || options.playoutCount < 1)
+        throw std::runtime_error("The search depth and the number of playouts must be positive");
+
+    if (options.gameCount < 1 || options.threadCount < 1)
+        throw std::runtime_error("The numbers of games and threads must be positive");
+
+    return options;
+}
+
+std::unique_ptr <MovePolicy> makePolicy(const Options& options)
+{
+    const auto& name = options.policyName;
+
+    if (name == "random")
+        return std::make_unique <RandomMovePolicy>();
+
+    if (name == "greedy")
+        return std::make_unique <GreedyMovePolicy>();
+
+    // The searches have no time limit, so the games stay reproducible
+    if (name == "expectimax")
+    {
+        auto policy = std::make_unique <ExpectimaxMovePolicy>();
+        policy->setMaxDepth(options.searchDepth);
+        return policy;
+    }
+
+    // Games are played on all the threads already, so every search has one thread
+    if (name == "mcts")
+    {
+        auto policy = std::make_unique <MctsMovePolicy>();
+        policy->setPlayoutBudget(options.playoutCount);
+        return policy;
+    }
+
+    throw std::runtime_error("Unknown policy " + name);
+}
+
+/*
+ * The name of the policy with the parameters it plays by, as the result file keeps it
+ */
+std::string describePolicy(const Options& options)
+{
+    if (options.policyName == "expectimax")
+        return "expectimax depth " + std::to_string(options.searchDepth);
+
+    if (options.policyName == "mcts")
+        return "mcts playouts " + std::to_string(options.playoutCount);
+
+    return options.policyName;
+}
+
+void writeCounters(const std::string& path)
+{
+    if (!Instrumentation::isEnabled())
+        std::cerr << "Warning: the engine is built without COLORLINES_INSTRUMENTATION, all the counters are zero\n";
+
+    const auto report = Instrumentation::collect();
+    const auto isPrometheus = path.size() >= 5 && path.compare(path.size() - 5, 5, ".prom") == 0;
+
+    std::ofstream file(path);
+    file << (isPrometheus ? Instrumentation::toPrometheus(report) : Instrumentation::toJson(report));
+
+    if (!file)
+        throw std::runtime_error("Cannot write file " + path);
+}
+
+void printReport(const Options& options, SimulationStatistics& statistics, const double seconds)
+{
+    std::cout << std::fixed << std::setprecision(1)
+              << "Seed:        " << options.seed << '\n'
+              << "Threads:     " << options.threadCount << '\n'
+              << "Games:       " << statistics.getGameCount() << '\n'
+              << "Moves:       " << statistics.getMoveCount() << '\n'
+              << "Time:        " << seconds << " s\n"
+              << "Games/sec:   " << statistics.getGameCount() / seconds << '\n'
+              << "Moves/sec:   " << statistics.getMoveCount() / seconds << '\n'
+              << '\n'
+              << "Score min:   " << statistics.getMinScore() << '\n'
+              << "Score mean:  " << statistics.getMeanScore() << '\n'
+              << "Score sd:    " << statistics.getScoreDeviation() << '\n'
+              << "Score p50:   " << statistics.getScorePercentile(0.50) << '\n'
+              << "Score p90:   " << statistics.getScorePercentile(0.90) << '\n'
+              << "Score p99:   " << statistics.getScorePercentile(0.99) << '\n'
+              << "Score max:   " << statistics.getMaxScore() << '\n'
+              << '\n'
+              << "Score histogram:\n";
+
+    auto width = 0;
+    const auto histogram = statistics.getScoreHistogram(10, width);
+    const auto min = statistics.getMinScore();
+
+    for (size_t i = 0; i < histogram.size(); i++)
+    {
+        std::cout << std::setw(8) << min + static_cast <int>(i) * width << " - "
+                  << std::setw(8) << min + static_cast <int>(i + 1) * width - 1 << ": "
+                  << histogram[i] << '\n';
+    }
+}
+
+/*
+ * Returns false if any finished game ends with another score
+ */
+bool verifyReplays(const std::string& path)
+{
+    ReplayReader reader(path);
+    GameEngine game;
+    ReplayGame replay;
+
+    auto gameCount = 0;
+    auto actionCount = 0;
+    auto unfinishedCount = 0;
+    auto mismatchCount = 0;
+
+    while (reader.readGame(replay))
+    {
+        gameCount++;
+        actionCount += static_cast <int>(replay.actions.size());
+
+        if (!replay.isFinished)
+            unfinishedCount++;
+
+        if (!ReplayReader::replayGame(game, replay))
+        {
+            mismatchCount++;
+            std::cout << "Game " << gameCount << ": recorded score " << replay.score
+                      << ", replayed score " << game.getScore() << '\n';
+        }
+    }
+
+    std::cout << "Games:       " << gameCount << '\n'
+              << "Actions:     " << actionCount << '\n'
+              << "Unfinished:  " << unfinishedCount << '\n'
+              << "Mismatches:  " << mismatchCount << '\n';
+
+    return mismatchCount == 0;
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        const auto options = parseOptions(argc, argv);
+
+        if (!options.verifyPath.empty())
+            return verifyReplays(options.verifyPath) ? 0 : 1;
+
+        // Every thread creates its own policy, so an unknown name is reported before they start
+        makePolicy(options);
+
+        BatchSettings settings {options.gameCount,
+                                options.widthInTiles,
+                                options.heightInTiles,
+                                options.colorCount,
+                                options.maxMoveCount,
+                                options.seed,
+                                options.randomAlgorithm,
+                                options.threadCount,
+                                16,
+                                describePolicy(options),
+                                {},
+                                options.isResumed};
+
+        // The snapshot is checked once here instead of failing on every thread
+        if (!options.startPath.empty())
+        {
+            SnapshotFile file(options.startPath);
+            settings.startPosition = file.read();
+
+            if (settings.startPosition.empty())
+                throw std::runtime_error("Cannot open file " + options.startPath);
+
+            GameEngine game;
+            game.load(settings.startPosition);
+        }
+
+        BatchRunner runner(settings, [&options]() { return makePolicy(options); });
+
+        std::unique_ptr <Logger> logger;
+        if (!options.logPath.empty())
+        {
+            logger = std::make_unique <Logger>(options.logPath, options.logLevel, 256 << 20, 3);
+            runner.setLogger(logger.get());
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        auto statistics = runner.run(options.outputPath, options.recordPath);
+        const std::chrono::duration <double> elapsed = std::chrono::steady_clock::now() - start;
+
+        printReport(options, statistics, elapsed.count());
+
+        if (logger != nullptr)
+            std::cout << "\nLog dropped: " << logger->getDroppedCount() << " events\n";
+
+        if (!options.countersPath.empty())
+            writeCounters(options.countersPath);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << '\n';
+        printUsage();
+        return 1;
+    }
+
+    return 0;
+}